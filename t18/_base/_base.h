@@ -29,6 +29,7 @@
 #include "../utils/HanaDescrMaps.h"
 
 #include "../utils/call_wrappers.h"
+#include "../utils/memFootprint.h"
 
 #include "../date_time.h"
 #include "../tags.h"
@@ -0,0 +1,86 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "tsohlcv.h"
+
+namespace t18 {
+
+	//integer price representation: a number of price ticks (minPriceDelta of a ticker)
+	typedef ::std::int64_t price_ticks_t;
+
+	//converts prices of a ticker to an integer number of ticks and back.
+	// When 1/tick is an integer (0.01, 0.5 and so on), prices are restored as (number of ticks)/(1/tick), which gives
+	// exactly the same double as parsing of a decimal string does. Otherwise they are restored as (number of ticks)*tick
+	// and may differ from the original values by a floating point rounding error.
+	// Prices that went through snap() are canonical: an equal number of ticks always means bitwise equal doubles.
+	// Note that the framework keeps storing and comparing prices as real_t, snapping just makes the values canonical
+	// (see tickerServer::snapPricesToTicks()). Integer ticks are used only where they are asked for explicitly.
+	struct priceTicks {
+		real_t step, inv;
+
+		priceTicks(real_t s)noexcept : step(s), inv(0) {
+			const real_t i = ::std::round(real_t(1) / s);
+			if (i >= 1 && ::std::abs(real_t(1) / s - i) < real_t(1e-9) * i) inv = i;
+		}
+
+		//the nearest number of ticks
+		price_ticks_t nearest(real_t v)const noexcept {
+			return ::std::llround(inv > 0 ? v * inv : v / step);
+		}
+
+		//the nearest number of ticks, bOnGrid is set to false if v is not on the ticks grid
+		price_ticks_t nearest(real_t v, bool& bOnGrid)const noexcept {
+			const real_t r = inv > 0 ? v * inv : v / step;
+			const auto n = ::std::llround(r);
+			bOnGrid = ::std::abs(r - static_cast<real_t>(n)) <= real_t(1e-3);
+			return n;
+		}
+
+		//the same as nearest(), but throws if v is not on the ticks grid
+		price_ticks_t exactTicks(real_t v, const char* pWhat = "price")const {
+			bool bOnGrid;
+			const auto n = nearest(v, bOnGrid);
+			if (UNLIKELY(!bOnGrid)) {
+				T18_ASSERT(!"Value doesn't fit to the tick size");
+				throw ::std::runtime_error(::std::string(pWhat) + " value " + ::std::to_string(v)
+					+ " doesn't fit to the tick size " + ::std::to_string(step));
+			}
+			return n;
+		}
+
+		real_t fromTicks(price_ticks_t n)const noexcept {
+			return inv > 0 ? static_cast<real_t>(n) / inv : static_cast<real_t>(n) * step;
+		}
+
+		//moves the price to the nearest canonical value on the ticks grid
+		real_t snap(real_t v)const noexcept { return fromTicks(nearest(v)); }
+
+		void snap(tsq_data& d)const noexcept { d.q = snap(d.q); }
+		void snap(tsohlcv& b)const noexcept {
+			b.o() = snap(b.o());
+			b.h = snap(b.h);
+			b.l = snap(b.l);
+			b.c = snap(b.c);
+		}
+	};
+
+}
@@ -285,6 +285,16 @@ namespace t18 {
 
 				template<typename HST, typename = ::std::enable_if_t<hana::is_a<hana::string_tag, HST>>>
 				const auto& getTs()const noexcept { return getTs(HST()); }
+
+				//only adapters that own a container are counted, pointed to timeseries belong to someone else
+				size_t adaptersHeapBytes()const noexcept {
+					size_t r = 0;
+					hana::for_each(m_Adpts, [&r](const auto& pr)noexcept {
+						const auto& a = hana::second(pr);
+						if constexpr (!::std::is_pointer_v<::std::decay_t<decltype(a)>>) r += ::utils::heapBytes(a);
+					});
+					return r;
+				}
 			};
 
 			//////////////////////////////////////////////////////////////////////////
@@ -293,11 +303,43 @@ namespace t18 {
 				struct stateStor {
 				protected:
 					StateT m_state;
+					//states after closed bars, the newest is at 0 and the initial state is the oldest. Empty unless
+					// rewinding is enabled, see tAlg::enableRewind()
+					TsCont_t<StateT> m_stateHist;
+
 				public:
 					StateT& getState()noexcept { return m_state; }
+					static constexpr size_t stateBytes()noexcept { return sizeof(StateT); }
+					size_t stateHistBytes()const noexcept { return ::utils::heapBytes(m_stateHist); }
+
+				protected:
+					void _enableStateHist(size_t nBars) {
+						m_stateHist.set_capacity(nBars + 1);
+						m_stateHist.push_front(m_state);
+					}
+					void _saveState()noexcept {
+						if (m_stateHist.capacity()) m_stateHist.push_front(m_state);
+					}
+					void _rewindState(size_t nClosedBars) {
+						if (!nClosedBars) return;
+						if (UNLIKELY(nClosedBars >= m_stateHist.size())) {
+							T18_ASSERT(!"Not enough state history to rewind!");
+							throw ::std::out_of_range("Not enough state history to rewind, see enableRewind()");
+						}
+						m_stateHist.erase_begin(nClosedBars);
+						m_state = m_stateHist[0];
+					}
 				};
 
-				struct stateStorDummy {};
+				struct stateStorDummy {
+					static constexpr size_t stateBytes()noexcept { return 0; }
+					static constexpr size_t stateHistBytes()noexcept { return 0; }
+
+				protected:
+					static void _enableStateHist(size_t)noexcept {}
+					static void _saveState()noexcept {}
+					static void _rewindState(size_t)noexcept {}
+				};
 			}
 
 			template<typename StateCandT>
@@ -407,11 +449,21 @@ namespace t18 {
 					const auto& getTStor(HST&& k)const noexcept {
 						return m_tStor[k];
 					}
+
+					size_t TStorHeapBytes()const noexcept {
+						size_t r = 0;
+						hana::for_each(m_tStor, [&r](const auto& pr)noexcept {
+							r += hana::second(pr).heapBytes();
+						});
+						return r;
+					}
 				};
 
 				struct TStorDummy {
 					template<typename T>
 					TStorDummy(T&)noexcept {}
+
+					static constexpr size_t TStorHeapBytes()noexcept { return 0; }
 				};
 			}
 
@@ -508,6 +560,22 @@ namespace t18 {
 			// See DEMA/TEMA for example, MA/EMA doesn't need/use this parameter
 			self_ref_t operator()(bool bClose) noexcept {
 				base_class_t::call(get_self(), bClose);
+				if (bClose) base_class_t::_saveState();
+				return get_self();
+			}
+
+			//Algorithms with a state must remember states of up to nBars closed bars to be able to rewind().
+			// Call it before the first bar is processed. Does nothing for stateless algorithms
+			void enableRewind(size_t nBars) {
+				base_class_t::_enableStateHist(nBars);
+			}
+
+			//forgets nBars newest bars, nClosedBars of them were processed with bClose==true (see TFUpdatesHandler::registerOnRewind())
+			// The state is restored to the state after the last remaining closed bar. Derived classes that own a dest
+			// container also drop its values. If the dest is not owned, its owner is responsible for dropping it.
+			self_ref_t rewind(size_t nBars, size_t nClosedBars) {
+				T18_ASSERT(nClosedBars <= nBars);
+				base_class_t::_rewindState(nClosedBars);
 				return get_self();
 			}
 
@@ -520,6 +588,16 @@ namespace t18 {
 			decltype(auto) operator[](size_t N) noexcept {
 				return get_self().getTs(typename base_class_t::adpt_dest_ht())[N];
 			}
+
+			//state is stored inside of the object, so it's reported as a part of the object size
+			::utils::memFootprint memoryFootprint(const char* name = "alg")const {
+				const size_t stB = base_class_t::stateBytes();
+				::utils::memFootprint r(name, sizeof(self_t) - stB);
+				if (stB) r.add("state", stB + base_class_t::stateHistBytes());
+				if (const auto b = base_tstor_t::TStorHeapBytes()) r.add("TStor", b);
+				if (const auto b = base_class_t::adaptersHeapBytes()) r.add("adapters", b);
+				return r;
+			}
 		};
 
 		//////////////////////////////////////////////////////////////////////////
@@ -588,6 +666,14 @@ namespace t18 {
 				return get_self();
 			}
 
+			self_ref_t rewind(size_t nBars, size_t nClosedBars) {
+				base_class_t::rewind(nBars, nClosedBars);
+				auto& d = base_class_t::getTs(adpt_dest_ht());
+				T18_ASSERT(nBars <= d.size());
+				d.erase_begin(::std::min(nBars, d.size()));
+				return get_self();
+			}
+
 		};
 
 		//note that for every class derived from tAlg2ts_select<true, ...>, notifyNewBarOpened() function MUST be called in order to
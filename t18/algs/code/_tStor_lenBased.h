@@ -56,6 +56,7 @@ namespace t18 {
 				}
 
 				size_t _len()const noexcept { return v.size(); }
+				size_t heapBytes()const noexcept { return ::utils::heapBytes(v); }
 
 				template<typename C, typename = ::std::enable_if_t< ::std::is_same_v< T, ::std::remove_const_t<typename C::value_type> >> >
 				void _copyFrom(const C& src) {
@@ -57,4 +57,5 @@ self_cref_t get_self() const noexcept {  return static_cast<self_cref_t>(*this);
 #include "_base/tsohlcv.h"
 #include "_base/tsDirTick.h"
 #include "_base/tsDeal.h"
+#include "_base/priceTicks.h"
 
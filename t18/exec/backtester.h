@@ -19,25 +19,27 @@
 
 //#include "../feeder/singleFile.h"
 #include "tradingInterface.h"
+#include "levelsIndex.h"
+#include "stopOrdersBook.h"
 #include "../market/MarketDataStorServ.h"
 
 namespace t18 { namespace exec {
 
-	//this class performs execution/evaluation of trading strategy over a history 
+	//the trade execution part of the backtester. It's a trading interface with its own trades, stop orders and portfolio
+	// that simulates execution of orders using data of tickers. It doesn't own any market data, the owner of the market
+	// (backtester or multiBacktester) forwards events of tickers to the _handle*() functions.
 	//#TODO #WARNING At this moment it's possible that a trade that have a stoploss/tp defined over another ticker
 	//would be closed with a timestamp of current bar, but using a close price of previous bar, should the stoploss/tp
 	// ticker be updated before the trade ticker update. To mitigate that issue we had to aggregate updates in a block,
 	// propagate updates to tickers/timeframes and only after that execute stoploss/tp checks. 
 	// Similar issues with scheduling new stop orders; they can be opened with a slighly wrong price if the opening price
 	// is given using another ticker
-	template<typename TickersSetHST>
-	class backtester 
+	class backtesterExec
 		: public tradingInterface
-		, public MarketDataStorServ<TickersSetHST>
 		, protected iExecTrade
 	{
 	public:
-		typedef backtester<TickersSetHST> self_t;
+		typedef backtesterExec self_t;
 		T18_TYPEDEFS_SELF()
 		
 		typedef tradingInterface base_class_trading_intf_t;
@@ -49,15 +51,9 @@ namespace t18 { namespace exec {
 
 		typedef tickerBase_t::bestPriceInfo_t bestPriceInfo_t;
 
-		typedef MarketDataStorServ<TickersSetHST> base_class_data_stor_t;
-		//using typename base_class_data_stor_t::ticker_t;
-		//using typename base_class_data_stor_t::tickerServ_t;
-
 		typedef iExecTrade base_exec_trade_t;
 		using typename base_exec_trade_t::openedTradesTimedCB_t;
 
-		//static_assert(::std::is_same_v<ticker_t, base_exec_trade_t::ticker_t>, "");
-
 	protected:
 		struct openedTradesCBInfo {
 			openedTradesTimedCB_t m_CB;
@@ -72,57 +68,18 @@ namespace t18 { namespace exec {
 
 		typedef ::std::list<openedTradesCBInfo> openedTradesTimedCBStor_t;
 
-		struct ordersStopData {
-			::std::vector<OrderData> m_odSet;
-			size_t m_total = 0;
-
-			void dropAll()noexcept {
-				if (m_total > 0) {
-					T18_ASSERT(m_odSet.size() >= m_total);
-					for (auto& e : m_odSet) {
-						e.clean();
-					}
-					m_total = 0;
-				}
-			}
-
-			size_t count()const { return m_total; }
-
-			void drop_idx(size_t i){
-				if (UNLIKELY(i >= m_odSet.size() || m_total <= 0)) {
-					T18_ASSERT(i < m_odSet.size());
-					T18_ASSERT(m_total > 0);
-					throw ::std::runtime_error("Invalid index!");
-				}
-				m_odSet[i].clean();
-				--m_total;
-			}
-
-			void addNew(OrderData&& od) {
-				T18_ASSERT(!od.is_clean());
-				if (UNLIKELY(m_total==m_odSet.size())) {
-					//creating new slot
-					m_odSet.push_back(::std::move(od));
-				} else {
-					//using existing slot
-					T18_ASSERT(m_total < m_odSet.size());
-					for (auto&e : m_odSet) {
-						if (e.is_clean()) {
-							e.set(::std::move(od));
-							break;
-						}
-					}
-				}
-				++m_total;
-			}
-		};
-
 	protected:
 		openedTradesTimedCBStor_t m_openedTradesTimedCBs;	
-		ordersStopData m_ordersStop;
+		stopOrdersBook m_ordersStop;
+		::std::vector<stopOrdersBook::hit_t> m_stopHits;
+
+		//stoploss/takeprofit levels of opened trades
+		levelsIndex m_levels;
+		::std::vector<tradeId_t> m_levelHits;
 
 	protected:
-		money_t m_curPortfolioAmount = money_t(1e6);
+		money_t m_initDeposit = money_t(1e6);
+		money_t m_curPortfolioAmount = m_initDeposit;
 		bool m_bVerboseTrading = true;
 
 		//////////////////////////////////////////////////////////////////////////
@@ -159,6 +116,7 @@ namespace t18 { namespace exec {
 
 			trd._cb_dealDone(typename trd_t::deals_t(openedAt.TS(), openedAt.q, v, trd.isLong()));
 			T18_ASSERT(TradeState::inMarket == trd.getState());
+			m_levels.update(trd);
 
 			//updating portfolio estimate first
 			//#TODO: For short trades balance estimate may be invalid
@@ -187,6 +145,7 @@ namespace t18 { namespace exec {
 			const auto v = trd.volumeInMarket();
 			trd._cb_dealDone(typename trd_t::deals_t(closedAt.TS(), closedAt.q, v, !trd.isLong()));
 			T18_ASSERT(TradeState::Closed == trd.getState());
+			m_levels.remove(tid);
 
 			//updating portfolio estimate first
 			m_curPortfolioAmount += trd.tradeProfit() + trd.plannedOpen().q*v*trd.Ticker().getLotSize();
@@ -200,14 +159,17 @@ namespace t18 { namespace exec {
 		virtual void _execTradeAbort(tradeId_t tid) override {
 			if (m_bVerboseTrading) STDCOUTL("Aborting everything about trade#" << tid);
 			auto& trd = getTradeEx(tid);
+			m_levels.remove(tid);
 			base_class_trading_intf_t::_cb_tradeCloseResult(trd, true);
 		};
 
 		virtual void _execTradeSetStopLoss(tradeId_t tid) override {
 			if (m_bVerboseTrading)STDCOUTL("setting stop loss for trade#" << tid);
+			_updateLevels(tid);
 		}
 		virtual void _execTradeSetTakeProfit(tradeId_t tid) override {
 			if (m_bVerboseTrading)STDCOUTL("setting take profit for trade#" << tid);
+			_updateLevels(tid);
 		}
 		virtual utils::regHandle _execScheduleTimedCallbackIfOpenedTrades(mxTime t, const tickerBase_t* pTickr, openedTradesTimedCB_t&& f) override {
 			m_openedTradesTimedCBs.emplace_back(::std::move(f), pTickr, t);
@@ -253,6 +215,58 @@ namespace t18 { namespace exec {
 		//////////////////////////////////////////////////////////////////////////
 
 	protected:
+		//see levelsIndex::cmpLvl()
+		static real_t _cmpLvl(const tickerBase_t& Tickr, const real_t lvl)noexcept {
+			return levelsIndex::cmpLvl(Tickr, lvl);
+		}
+
+		void _updateLevels(tradeId_t tid) {
+			const auto& trd = getTradeEx(tid);
+			//levels of a trade are indexed once it's opened
+			if (trd.is_SomethingInMarket()) m_levels.update(trd);
+		}
+
+		//calls f(trade, levels) for every opened trade which stoploss or takeprofit for the Tickr is triggered by a price
+		// within [lo, hi]. levels are a copy of levelsIndex::tradeLevels of the trade, they are already comparable with
+		// prices of the Tickr. Some of these trades might not be triggered actually, if both their stoploss and takeprofit
+		// are set, so f must check levels again. Trades are processed in the order of their opening, like
+		// forEachOpenedTradeEx() does
+		template<typename F>
+		void _forEachLevelHit(const tickerBase_t& Tickr, real_t lo, real_t hi, F&& f) {
+			m_levelHits.clear();
+			m_levels.select(Tickr, lo, hi, m_levelHits);
+			for (const auto tid : m_levelHits) {
+				//callbacks of a trade closed by f might have closed other selected trades or dropped their levels
+				const auto& t = getTradeEx(tid);
+				if (t.is_Closed() || t.is_Failed()) continue;
+				const auto tl = m_levels.levelsOf(tid);
+				if (!tl.pSlTickr && !tl.pTpTickr) continue;
+				::std::forward<F>(f)(getTradeEx(tid), tl);
+			}
+		}
+
+		//executes pending stop orders for the Tickr, which are triggered by a price within [lo, hi] and are active at time t.
+		// fBeforeExec(const OrderData&) is called just before an order execution. Orders are executed in the order of placement
+		template<typename F>
+		void _forEachStopOrderHit(const tickerBase_t& Tickr, real_t lo, real_t hi, mxTime t, F&& fBeforeExec) {
+			m_stopHits.clear();
+			m_ordersStop.select(Tickr, lo, hi, m_stopHits);
+			for (const auto& h : m_stopHits) {
+				//a TS might have dropped the order while other orders were executed
+				if (!m_ordersStop.holds(h)) continue;
+				//TS callbacks of the new trade may place new orders, so using a copy
+				const auto od = m_ordersStop.order(h.slot);
+				if (od.m_timeActive.shouldAllow(t)) {
+					T18_ASSERT(Tickr == od.m_prOpen.getTicker());
+					::std::forward<F>(fBeforeExec)(od);
+
+					//opening a trade and dropping the order
+					od.makeMarketTrade(*this);
+					if (m_ordersStop.holds(h)) m_ordersStop.drop(h.slot);
+				}
+			}
+		}
+
 		static void _setBestGuessBidAsk(tickerBase_t& Tickr, const tsq_data& tsq)noexcept {
 			Tickr.setBestBidAsk(bestPriceInfo_t(tsq.TS(), tsq.q, ::std::numeric_limits<volume_t>::epsilon())
 				, bestPriceInfo_t(tsq.TS(), tsq.q + Tickr.getMinPriceDelta(), ::std::numeric_limits<volume_t>::epsilon()));
@@ -267,33 +281,54 @@ namespace t18 { namespace exec {
 			T18_COMP_POP;
 		}
 
+	public:
+		//////////////////////////////////////////////////////////////////////////
+		// handlers of ticker events. They must be called by the owner of the market before any TS callbacks
+		//////////////////////////////////////////////////////////////////////////
+
 		void _handleNewBarOpen(tickerBase_t& Tickr, const tsq_data& tso) {
+			const bool bHadTrades = _handleNewBarOpen_timed(Tickr, tso);
+			_handleNewBarOpen_levels(Tickr, tso, bHadTrades);
+		}
+
+		//the first part of _handleNewBarOpen(): makes scheduled timed callbacks. They may set the best bid/ask of
+		// the ticker back to the previous bar.
+		// Returns whether there were opened trades, the result must be passed to _handleNewBarOpen_levels()
+		bool _handleNewBarOpen_timed(tickerBase_t& Tickr, const tsq_data& tso) {
 			//T18_ASSERT(dto == Tickr.getLastKnownQuote());
 			//this assert is wrong, because callback is called before last quote update
 			
 			//new bar mustn't be added to the base yet as well as any other timeframe object bc of how handling of timed-callbacks work
 			T18_ASSERT(Tickr.notFilledYet() || tso.TS() > Tickr.getLastSeenTS());
 
-			bool bBidAskSet = false;
-
-			if (base_class_trading_intf_t::openedTradesCount() > 0) {
+			const bool bHadTrades = base_class_trading_intf_t::openedTradesCount() > 0;
+			if (bHadTrades && m_openedTradesTimedCBs.size()) {
 				//we should check if we must call to scheduled callback
-				if (m_openedTradesTimedCBs.size()) {
-					_doScheduledTimedCallbacksIfOpenTrades(Tickr, tso);
-				}
+				_doScheduledTimedCallbacksIfOpenTrades(Tickr, tso);
+			}
+			return bHadTrades;
+		}
+
+		//the second part of _handleNewBarOpen(): checks stoplosses, takeprofits and stop orders against the bar open.
+		// bHadTrades is the result of _handleNewBarOpen_timed(): timed callbacks might have closed all the trades, but
+		// they've still set the best bid/ask to the previous bar, so it must be reset to the bar open anyway
+		void _handleNewBarOpen_levels(tickerBase_t& Tickr, const tsq_data& tso, const bool bHadTrades) {
+			bool bBidAskSet = false;
 
+			if (bHadTrades || base_class_trading_intf_t::openedTradesCount() > 0) {
 				//best guess
 				_setBestGuessBidAsk(Tickr, tso);
 				bBidAskSet = true;
+			}
 
-				base_class_trading_intf_t::forEachOpenedTradeEx([&Tickr, lq = tso](tradeEx_t& t) {
+			if (base_class_trading_intf_t::openedTradesCount() > 0) {
+				_forEachLevelHit(Tickr, tso.q, tso.q, [&Tickr, lq = tso](tradeEx_t& t, const levelsIndex::tradeLevels& tl) {
 					T18_ASSERT(!t.is_Closed() && !t.is_Failed());
 
 					const bool bLong = t.isLong();
 					bool bClosed = false;
-					const auto& sl = t.StopLoss();
-					if (sl.isSet() && sl.getTicker() == Tickr) {
-						const auto lvl = sl.getLvl();
+					if (tl.pSlTickr == &Tickr) {
+						const auto lvl = tl.slLvl;
 						if ((bLong && lq.q <= lvl) || (!bLong && lq.q >= lvl)) {
 							t.closeByMarket(TradeCloseReason::StopLoss);
 							bClosed = true;
@@ -301,9 +336,8 @@ namespace t18 { namespace exec {
 					}
 
 					if (!bClosed) {
-						const auto& tp = t.TakeProfit();
-						if (tp.isSet() && tp.getTicker() == Tickr) {
-							const auto lvl = tp.getLvl();
+						if (tl.pTpTickr == &Tickr) {
+							const auto lvl = tl.tpLvl;
 							if ((bLong && lq.q >= lvl) || (!bLong && lq.q <= lvl)) {
 								//#todo: should take profit be implemented using limit orders?
 								t.closeByMarket(TradeCloseReason::TakeProfit);
@@ -320,25 +354,7 @@ namespace t18 { namespace exec {
 					_setBestGuessBidAsk(Tickr, tso);
 				}
 
-				const auto lqv = tso.q;
-				size_t i = 0;
-				for (auto& od : m_ordersStop.m_odSet) {
-					if (!od.is_clean() && Tickr == od.m_prOpen.getTicker() && od.m_timeActive.shouldAllow(tso.Time())) {
-						T18_ASSERT(od.m_prOpen.isSet());
-						T18_ASSERT(m_ordersStop.count() > 0);
-						//do check
-						const auto openLvl = od.m_prOpen.getLvl();
-						if ((od.m_bLong && lqv > openLvl) || (!od.m_bLong && lqv < openLvl)) {
-							//opening a trade and cleaning the od
-							od.makeMarketTrade(*this);
-
-							m_ordersStop.drop_idx(i);
-							T18_ASSERT(od.is_clean());
-							//if (0 == m_ordersStop.count()) break;
-						}
-					}
-					++i;
-				}
+				_forEachStopOrderHit(Tickr, tso.q, tso.q, tso.Time(), [](const OrderData&) {});
 			}
 		}
 
@@ -361,19 +377,16 @@ namespace t18 { namespace exec {
 				_setBestGuessBidAsk(Tickr, bar);
 				bBidAskSet = true;
 
-				base_class_trading_intf_t::forEachOpenedTradeEx([&Tickr, &bar](tradeEx_t& t) {
+				_forEachLevelHit(Tickr, bar.l, bar.h, [&Tickr, &bar](tradeEx_t& t, const levelsIndex::tradeLevels& tl) {
 					T18_ASSERT(!t.is_Closed() && !t.is_Failed());
 
-					const auto& sl = t.StopLoss();
-					const auto& tp = t.TakeProfit();
-
-					const bool slSuits = sl.isSet() && Tickr == sl.getTicker();
-					const bool tpSuits = tp.isSet() && Tickr == tp.getTicker();
+					const bool slSuits = tl.pSlTickr == &Tickr;
+					const bool tpSuits = tl.pTpTickr == &Tickr;
 
 					if (slSuits || tpSuits) {
 						const bool bLong = t.isLong();
-						const real_t slLvl = slSuits ? sl.getLvl() : real_t(0);
-						const real_t tpLvl = tpSuits ? tp.getLvl() : real_t(0);
+						const real_t slLvl = slSuits ? tl.slLvl : real_t(0);
+						const real_t tpLvl = tpSuits ? tl.tpLvl : real_t(0);
 
 						//#TODO need a better solution for the condition
 						if (UNLIKELY(slSuits && tpSuits && slLvl >= bar.l && slLvl <= bar.h && tpLvl >= bar.l && tpLvl <= bar.h))
@@ -405,43 +418,27 @@ namespace t18 { namespace exec {
 
 			//checking whether we should launch some OrderStop
 			if (m_ordersStop.count() > 0) {
-				size_t i = 0;
-				for (auto& od : m_ordersStop.m_odSet) {
-					if (!od.is_clean() && Tickr == od.m_prOpen.getTicker() && od.m_timeActive.shouldAllow(bar.Time())) {
-						T18_ASSERT(od.m_prOpen.isSet());
-						T18_ASSERT(m_ordersStop.count() > 0);
-						const auto openLvl = od.m_prOpen.getLvl();
-						const auto bLong = od.m_bLong;
-						//do check
-						if ((bLong && bar.h > openLvl) || (!bLong && bar.l < openLvl)) {
-							T18_ASSERT(openLvl <= bar.h && openLvl >= bar.l);
-							//must check, that SL/TP won't be triggered by the same bar, else it's unresolvable
-							const auto& sl = od.m_prSl;
-							if (UNLIKELY(sl.isSet() && sl.getTicker()==Tickr && ((bLong && sl.getLvl() > bar.l) || (!bLong && sl.getLvl() < bar.h)))) {
-								T18_ASSERT(!"Cant resolve SL for the OrderStop");
-								throw ::std::runtime_error("Cant resolve SL for the OrderStop at bar "s + bar.TS().to_string());
-							}
-							const auto& tp = od.m_prTp;
-							if (UNLIKELY(tp.isSet() && tp.getTicker()==Tickr && ((bLong && tp.getLvl() < bar.h) || (!bLong && tp.getLvl() > bar.l)))) {
-								T18_ASSERT(!"Cant resolve TP for the OrderStop");
-								throw ::std::runtime_error("Cant resolve TP for the OrderStop at bar "s + bar.TS().to_string());
-							}
-
-							//opening a trade and cleaning the od
-							if (!bBidAskSet) {
-								//best guess
-								_setBestGuessBidAsk(Tickr, bar);
-								bBidAskSet = true;
-							}
-							od.makeMarketTrade(*this);
+				_forEachStopOrderHit(Tickr, bar.l, bar.h, bar.Time(), [&Tickr, &bar, &bBidAskSet](const OrderData& od) {
+					const auto bLong = od.m_bLong;
+					T18_ASSERT(_cmpLvl(Tickr, od.m_prOpen.getLvl()) <= bar.h && _cmpLvl(Tickr, od.m_prOpen.getLvl()) >= bar.l);
+					//must check, that SL/TP won't be triggered by the same bar, else it's unresolvable
+					const auto& sl = od.m_prSl;
+					if (UNLIKELY(sl.isSet() && sl.getTicker()==Tickr && ((bLong && _cmpLvl(Tickr, sl.getLvl()) > bar.l) || (!bLong && _cmpLvl(Tickr, sl.getLvl()) < bar.h)))) {
+						T18_ASSERT(!"Cant resolve SL for the OrderStop");
+						throw ::std::runtime_error("Cant resolve SL for the OrderStop at bar "s + bar.TS().to_string());
+					}
+					const auto& tp = od.m_prTp;
+					if (UNLIKELY(tp.isSet() && tp.getTicker()==Tickr && ((bLong && _cmpLvl(Tickr, tp.getLvl()) < bar.h) || (!bLong && _cmpLvl(Tickr, tp.getLvl()) > bar.l)))) {
+						T18_ASSERT(!"Cant resolve TP for the OrderStop");
+						throw ::std::runtime_error("Cant resolve TP for the OrderStop at bar "s + bar.TS().to_string());
+					}
 
-							m_ordersStop.drop_idx(i);
-							T18_ASSERT(od.is_clean());
-							//if (0 == m_ordersStop.count()) break;
-						}
+					if (!bBidAskSet) {
+						//best guess
+						_setBestGuessBidAsk(Tickr, bar);
+						bBidAskSet = true;
 					}
-					++i;
-				}
+				});
 			}
 		}
 
@@ -452,6 +449,7 @@ namespace t18 { namespace exec {
 			}
 		}
 
+	protected:
 		static constexpr decltype(::std::declval<mxTime>().SecondOfDay()) _ScheduleTimedCallbacksIfOpenTrades_maxSecondsNoWarn = 60;
 
 		void _doScheduledTimedCallbacksIfOpenTrades(tickerBase_t& Tickr, const tsq_data& curTsq) {
@@ -524,24 +522,100 @@ namespace t18 { namespace exec {
 			}
 		}
 
+		//drops trades, stop orders and timed callbacks keeping the storage allocated for them
+		void _resetTrading() {
+			T18_ASSERT(m_openedTradesTimedCBs.empty() || !"Timed callbacks mustn't outlive a run");
+			m_openedTradesTimedCBs.clear();
+			m_ordersStop.dropAll();
+			m_levels.clear();
+			m_levelHits.clear();
+			m_stopHits.clear();
+			base_class_trading_intf_t::_reset();
+			m_curPortfolioAmount = m_initDeposit;
+		}
+
+		void _addMemoryFootprint(::utils::memFootprint& r)const {
+			r.bytes += ::utils::heapBytes(m_openedTradesTimedCBs);
+			r.add("ordersStop", m_ordersStop.heapBytes() + ::utils::heapBytes(m_stopHits));
+			r.add("levelsIndex", m_levels.heapBytes() + ::utils::heapBytes(m_levelHits));
+			r.add(base_class_trading_intf_t::memoryFootprint());
+		}
+
+	public:
+		virtual ~backtesterExec() override {}
+		backtesterExec() : base_class_trading_intf_t(this) {}
+
+		::utils::memFootprint memoryFootprint(const char* name = "backtesterExec")const {
+			::utils::memFootprint r(name, sizeof(self_t) - sizeof(base_class_trading_intf_t));
+			_addMemoryFootprint(r);
+			return r;
+		}
+
+		void verboseTrading(bool b)noexcept { m_bVerboseTrading = b; }
+		self_ref_t silence()noexcept { 
+			m_bVerboseTrading = false;
+			return *this;
+		}
+
+		void SetInitDeposit(real_t v) {
+			if (UNLIKELY(v<=0)) {
+				T18_ASSERT(!"Invalid initial deposit!");
+				throw ::std::logic_error("Invalid initial deposit!");
+			}
+			m_initDeposit = v;
+			m_curPortfolioAmount = v;
+		}
+	};
+
+	//this class performs execution/evaluation of trading strategy over a history 
+	template<typename TickersSetHST>
+	class backtester 
+		: public backtesterExec
+		, public MarketDataStorServ<TickersSetHST>
+	{
+	public:
+		typedef backtester<TickersSetHST> self_t;
+		T18_TYPEDEFS_SELF()
+
+		typedef backtesterExec base_class_exec_t;
+		typedef tradingInterface base_class_trading_intf_t;
+
+		typedef MarketDataStorServ<TickersSetHST> base_class_data_stor_t;
+		//using typename base_class_data_stor_t::ticker_t;
+		//using typename base_class_data_stor_t::tickerServ_t;
+
+	protected:
+		//set by reset(true) or setupMarket(), the next run() reuses the market as is
+		bool m_bMarketKept = false;
+
 	public:
 		virtual ~backtester() override {}
-		backtester() : base_class_trading_intf_t(this), base_class_data_stor_t() {}
+		backtester() : base_class_exec_t(), base_class_data_stor_t() {}
 
 		using base_class_data_stor_t::tickersCount;
 
+		//combines the reports of the market data storage and the trading interface
+		::utils::memFootprint memoryFootprint(const char* name = "backtester")const {
+			::utils::memFootprint r(name, sizeof(self_t) - sizeof(base_class_trading_intf_t) - sizeof(base_class_data_stor_t));
+			base_class_exec_t::_addMemoryFootprint(r);
+			r.add(base_class_data_stor_t::memoryFootprint());
+			return r;
+		}
+
 		template<typename TsSetupT, typename FeederT>
 		void run(TsSetupT&& so, FeederT&& feed) {//&& is just universal refs here
 			typedef typename ::std::remove_reference<TsSetupT>::type ts_setup_t;
 
-			//first ensure we're not reusing this object as it'll require some cleanup code I don't want to write now.
-			if (tickersCount() > 0 || tradesCount() > 0) {
-				T18_ASSERT(!"backtester object reusing is not supported");
-				throw ::std::logic_error("backtester object reusing is not supported");
+			//first ensure we're not reusing this object without a cleanup
+			if ((tickersCount() > 0 && !m_bMarketKept) || tradesCount() > 0) {
+				T18_ASSERT(!"backtester must be reset() before reusing");
+				throw ::std::logic_error("backtester must be reset() before reusing");
 			}
 
 			//performing the setup and obtaining runtime config
-			so.setup(*static_cast<base_class_data_stor_t*>(this));
+			if (m_bMarketKept) {
+				m_bMarketKept = false;
+			} else so.setup(*static_cast<base_class_data_stor_t*>(this));
 
 			//some checks
 			if (!tickersCount()) {
@@ -585,18 +659,38 @@ namespace t18 { namespace exec {
 			//done here. TS object will be destroyed, however, the TsSetupT& so won't
 		}
 
-		void verboseTrading(bool b)noexcept { m_bVerboseTrading = b; }
-		self_ref_t silence()noexcept { 
-			m_bVerboseTrading = false;
-			return *this;
+		//Returns the backtester to a fresh state, so run() could be called again. Trades and stop orders are dropped, but
+		// the storage allocated for them is reused by the next run. The settings of the backtester (such as the initial
+		// deposit) are kept.
+		//If bKeepMarket is set, tickers are kept too along with their timeframes, settings and storage, only the market
+		// data is dropped. The next run() then doesn't call setup() of the TS setup object, so the runtime parameters it
+		// sets must already be there, and the TS must suit the market as is. Note that history sizes of the timeframes
+		// remain those the first setup had chosen, so the first run should be made with the most demanding parameters.
+		void reset(bool bKeepMarket = false) {
+			base_class_exec_t::_resetTrading();
+
+			if (bKeepMarket) {
+				base_class_data_stor_t::_resetData();
+			} else base_class_data_stor_t::_clearTickers();
+			m_bMarketKept = bKeepMarket && tickersCount() > 0;
 		}
 
-		void SetInitDeposit(real_t v) {
-			if (UNLIKELY(v<=0)) {
-				T18_ASSERT(!"Invalid initial deposit!");
-				throw ::std::logic_error("Invalid initial deposit!");
+		//makes the market of a fresh backtester with the setup() of so, so that the next run() reuses it just as after
+		// reset(true). That's for several runs of a TS with different runtime parameters, when so is the most demanding
+		// setup (i.e. its timeframes have the longest histories any run needs)
+		template<typename TsSetupT>
+		void setupMarket(TsSetupT& so) {
+			if (tickersCount() > 0 || tradesCount() > 0) {
+				T18_ASSERT(!"backtester must be empty to setup a market");
+				throw ::std::logic_error("backtester must be empty to setup a market");
 			}
-			m_curPortfolioAmount = v;
+			so.setup(*static_cast<base_class_data_stor_t*>(this));
+			m_bMarketKept = tickersCount() > 0;
+		}
+
+		self_ref_t silence()noexcept { 
+			base_class_exec_t::silence();
+			return *this;
 		}
 	};
 
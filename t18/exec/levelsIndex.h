@@ -0,0 +1,124 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "trade.h"
+#include "priceLevels.h"
+
+namespace t18 { namespace exec {
+
+	//sorted index of stoploss and takeprofit levels of opened trades. Stoplosses of long trades and takeprofits of short
+	// trades are triggered by falling prices, the others - by rising prices, so trades that a price range might trigger
+	// are found with a binary search instead of checking every opened trade.
+	class levelsIndex {
+		typedef levelsIndex self_t;
+	public:
+		typedef tickerBase tickerBase_t;
+		typedef trade::tradeId_t tradeId_t;
+
+		typedef priceLevels<tradeId_t> priceLevels_t;
+
+		//what is indexed for a trade. Levels are as they are compared with prices, see cmpLvl(). A null ticker pointer
+		// means the level isn't set
+		struct tradeLevels {
+			const tickerBase_t* pSlTickr = nullptr;
+			const tickerBase_t* pTpTickr = nullptr;
+			real_t slLvl = 0, tpLvl = 0;
+			bool bLong = false;
+		};
+
+	protected:
+		priceLevels_t m_levels;
+		//indexed by trade id
+		::std::vector<tradeLevels> m_trades;
+
+	public:
+		static real_t cmpLvl(const tickerBase_t& Tickr, const real_t lvl)noexcept {
+			return priceLevels_t::cmpLvl(Tickr, lvl);
+		}
+
+		size_t count()const noexcept { return m_levels.count(); }
+
+		//levels indexed for the trade
+		const tradeLevels& levelsOf(tradeId_t tid)const noexcept {
+			T18_ASSERT(tid < m_trades.size());
+			return m_trades[tid];
+		}
+
+		//indexes current stoploss and takeprofit levels of the trade t instead of ones indexed for it before
+		void update(const trade& t) {
+			const auto tid = t.TradeId();
+			remove(tid);
+			if (m_trades.size() <= tid) m_trades.resize(tid + 1);
+			auto& tl = m_trades[tid];
+			tl.bLong = t.isLong();
+
+			const auto& sl = t.StopLoss();
+			if (sl.isSet()) {
+				tl.pSlTickr = &sl.getTicker();
+				tl.slLvl = cmpLvl(sl.getTicker(), sl.getLvl());
+				m_levels.insert(*tl.pSlTickr, tl.bLong, tl.slLvl, tid);
+			}
+			const auto& tp = t.TakeProfit();
+			if (tp.isSet()) {
+				tl.pTpTickr = &tp.getTicker();
+				tl.tpLvl = cmpLvl(tp.getTicker(), tp.getLvl());
+				m_levels.insert(*tl.pTpTickr, !tl.bLong, tl.tpLvl, tid);
+			}
+		}
+
+		//drops levels of the trade from the index, if any
+		void remove(tradeId_t tid)noexcept {
+			if (tid >= m_trades.size()) return;
+			auto& tl = m_trades[tid];
+			if (tl.pSlTickr) {
+				m_levels.erase(*tl.pSlTickr, tl.bLong, tl.slLvl, tid);
+				tl.pSlTickr = nullptr;
+			}
+			if (tl.pTpTickr) {
+				m_levels.erase(*tl.pTpTickr, !tl.bLong, tl.tpLvl, tid);
+				tl.pTpTickr = nullptr;
+			}
+		}
+
+		//appends to dest ids of trades which levels for the Tickr are within a price range [lo, hi] or beyond it in the
+		// direction that triggers them. Trade ids are sorted and unique.
+		void select(const tickerBase_t& Tickr, real_t lo, real_t hi, ::std::vector<tradeId_t>& dest)const {
+			const auto first = dest.size();
+			m_levels.forEachTriggered(Tickr, lo, hi, true, [&dest](tradeId_t tid) {
+				dest.push_back(tid);
+			});
+			::std::sort(dest.begin() + first, dest.end());
+			dest.erase(::std::unique(dest.begin() + first, dest.end()), dest.end());
+		}
+
+		//drops everything keeping the storage allocated
+		void clear()noexcept {
+			m_levels.clear();
+			m_trades.clear();
+		}
+
+		size_t heapBytes()const noexcept {
+			return m_levels.heapBytes() + ::utils::heapBytes(m_trades);
+		}
+	};
+
+} }
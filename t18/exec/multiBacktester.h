@@ -0,0 +1,190 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <string>
+
+#include "backtester.h"
+
+namespace t18 { namespace exec {
+
+	//multiBacktester evaluates many instances of a TS (usually with different parameters) over a single pass of the data.
+	// The market (tickers with their timeframes) is shared by all instances, so the data is fed and converted to higher
+	// timeframes only once, while every instance trades via its own tenant - a backtesterExec object with its own
+	// trades, stop orders and portfolio. Indicators that TS objects calculate aren't shared, every instance has its own.
+	// The market is made by setup() of the first setup object only, so it must be the most demanding one (for example,
+	// it must require the longest histories), and runtime parameters of the other setup objects must already be set.
+	// Results of every tenant are the same as results of a separate backtester run with the same setup object. The only
+	// exception is that TS callbacks fired by notifyDateTime() after timed callbacks of a tenant see the best bid/ask the
+	// ticker has got from the feed instead of the guess the timed callbacks made (see _forEachTenant()).
+	template<typename TickersSetHST>
+	class multiBacktester : public MarketDataStorServ<TickersSetHST> {
+	public:
+		typedef multiBacktester<TickersSetHST> self_t;
+		T18_TYPEDEFS_SELF()
+
+		typedef MarketDataStorServ<TickersSetHST> base_class_data_stor_t;
+		typedef backtesterExec tenant_t;
+		typedef tickerBase tickerBase_t;
+
+	protected:
+		::std::vector<::std::unique_ptr<tenant_t>> m_tenants;
+
+		money_t m_initDeposit = money_t(1e6);
+		bool m_bVerboseTrading = true;
+
+	protected:
+		//handlers of a tenant set the best bid/ask of the Tickr to their own guesses, so every tenant must start from the
+		// best bid/ask the Tickr has got from the feed, and the Tickr gets it back once all the tenants are done
+		template<typename F>
+		void _forEachTenant(tickerBase_t& Tickr, F&& f) {
+			const auto bid = Tickr.getBestBid();
+			const auto ask = Tickr.getBestAsk();
+			for (auto& p : m_tenants) {
+				::std::forward<F>(f)(*p);
+				Tickr._restoreBestBidAsk(bid, ask);
+			}
+		}
+
+		void _handleNewBarOpen(tickerBase_t& Tickr, const tsq_data& tso) {
+			_forEachTenant(Tickr, [&Tickr, &tso](tenant_t& t) { t._handleNewBarOpen(Tickr, tso); });
+		}
+		template<typename BarT>
+		void _handleNewBarClose(tickerBase_t& Tickr, const BarT& bar) {
+			_forEachTenant(Tickr, [&Tickr, &bar](tenant_t& t) { t._handleNewBarClose(Tickr, bar); });
+		}
+		void _handleNotifyDateTime(tickerBase_t& Tickr, mxTimestamp curTs) {
+			_forEachTenant(Tickr, [&Tickr, curTs](tenant_t& t) { t._handleNotifyDateTime(Tickr, curTs); });
+		}
+
+	public:
+		multiBacktester() : base_class_data_stor_t() {}
+
+		using base_class_data_stor_t::tickersCount;
+
+		size_t tenantsCount()const noexcept { return m_tenants.size(); }
+
+		//the trading interface of a TS instance, i is the index of its setup object passed to run()
+		tenant_t& tenant(size_t i) {
+			if (UNLIKELY(i >= m_tenants.size())) {
+				T18_ASSERT(!"Invalid tenant index");
+				throw ::std::out_of_range("Invalid tenant index " + ::std::to_string(i));
+			}
+			return *m_tenants[i];
+		}
+		const tenant_t& tenant(size_t i)const {
+			return const_cast<self_t*>(this)->tenant(i);
+		}
+
+		::utils::memFootprint memoryFootprint(const char* name = "multiBacktester")const {
+			::utils::memFootprint r(name, sizeof(self_t) - sizeof(base_class_data_stor_t) + ::utils::heapBytes(m_tenants));
+			for (size_t i = 0; i < m_tenants.size(); ++i) {
+				r.add(m_tenants[i]->memoryFootprint(("tenant#" + ::std::to_string(i)).c_str()));
+			}
+			r.add(base_class_data_stor_t::memoryFootprint());
+			return r;
+		}
+
+		//setups is a container of setup objects (of the same type) for every TS instance to run. Tenants are made in
+		// the order of the setups
+		template<typename SetupsContT, typename FeederT>
+		void run(SetupsContT& setups, FeederT&& feed) {//&& is just universal refs here
+			typedef typename ::std::decay_t<SetupsContT>::value_type ts_setup_t;
+			typedef typename ts_setup_t::ts_t ts_t;
+
+			if (tickersCount() > 0 || m_tenants.size()) {
+				T18_ASSERT(!"multiBacktester object reusing is not supported");
+				throw ::std::logic_error("multiBacktester object reusing is not supported");
+			}
+			const auto nSetups = static_cast<size_t>(::std::distance(::std::begin(setups), ::std::end(setups)));
+			if (!nSetups) {
+				T18_ASSERT(!"At least one setup object must be passed!");
+				throw ::std::logic_error("At least one setup object must be passed!");
+			}
+
+			//the market is made by the first setup
+			::std::begin(setups)->setup(*static_cast<base_class_data_stor_t*>(this));
+
+			if (!tickersCount()) {
+				T18_ASSERT(!"At least one ticker must be added!");
+				throw ::std::logic_error("At least one ticker must be added!");
+			}
+
+			m_tenants.reserve(nSetups);
+			for (size_t i = 0; i < nSetups; ++i) {
+				auto p = ::std::make_unique<tenant_t>();
+				p->verboseTrading(m_bVerboseTrading);
+				p->SetInitDeposit(m_initDeposit);
+				m_tenants.push_back(::std::move(p));
+			}
+
+			//see backtester::run()
+			::std::vector<utils::regHandle> hStor;
+			hStor.reserve(3 * tickersCount());
+
+			base_class_data_stor_t::forEachTicker([&hStor, ths = this](auto& t) {
+				typedef ::std::decay_t<decltype(t)> ticker_t;
+
+				if (t.countOfOnNewBarClose() || t.countOfOnNewBarOpen() || t.countOfOnNotifyDateTime()) {
+					T18_ASSERT(!"WTF? Don't register callbacks on Ticker object during TS setup!");
+					throw ::std::logic_error("WTF? Don't register callbacks on Ticker object during TS setup!");
+				}
+
+				hStor.push_back(t.registerOnNewBarOpen(::std::bind(&self_t::_handleNewBarOpen
+					, ths, ::std::ref(t.getTickerBase()), ::std::placeholders::_1)));
+				hStor.push_back(t.registerOnNewBarClose(::std::bind(&self_t::_handleNewBarClose<typename ticker_t::bar_t>
+					, ths, ::std::ref(t.getTickerBase()), ::std::placeholders::_1)));
+				hStor.push_back(t.registerOnNotifyDateTime(::std::bind(&self_t::_handleNotifyDateTime
+					, ths, ::std::ref(t.getTickerBase()), ::std::placeholders::_1)));
+			});
+
+			//TS objects are created in heap as they might be big
+			::std::vector<::std::unique_ptr<ts_t>> tss;
+			tss.reserve(nSetups);
+			size_t i = 0;
+			for (auto& so : setups) {
+				tss.push_back(::std::make_unique<ts_t>(
+					*static_cast<typename base_class_data_stor_t::MarketDataStor_t *>(this)
+					, *static_cast<exec::tradingInterface*>(m_tenants[i++].get())
+					, so));
+			}
+
+			//feeding data into all TS at once
+			feed(*static_cast<base_class_data_stor_t*>(this));
+		}
+
+		void verboseTrading(bool b)noexcept { m_bVerboseTrading = b; }
+		self_ref_t silence()noexcept {
+			m_bVerboseTrading = false;
+			return *this;
+		}
+
+		//the initial deposit of every tenant
+		void SetInitDeposit(real_t v) {
+			if (UNLIKELY(v <= 0)) {
+				T18_ASSERT(!"Invalid initial deposit!");
+				throw ::std::logic_error("Invalid initial deposit!");
+			}
+			m_initDeposit = v;
+		}
+	};
+
+} }
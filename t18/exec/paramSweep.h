@@ -0,0 +1,153 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "backtester.h"
+#include "../utils/workStealingPool.h"
+
+namespace t18 { namespace exec {
+
+	//a summary of a backtest that paramSweep returns by default
+	struct sweepMetrics {
+		money_t equity = money_t(0);//at the end of the run
+		money_t profit = money_t(0);//total profit of closed trades
+		size_t nTrades = 0;
+		size_t nClosed = 0;
+		size_t nProfitable = 0;
+
+		template<typename BtT>
+		static sweepMetrics of(const BtT& bt) {
+			sweepMetrics r;
+			r.equity = bt.GetEquity();
+			r.nTrades = bt.tradesCount();
+			bt.forEachTrade([&r](const auto& t) {
+				if (t.is_Closed() && !t.is_Failed()) {
+					++r.nClosed;
+					const auto p = t.tradeProfit();
+					r.profit += p;
+					if (p > 0) ++r.nProfitable;
+				}
+			});
+			return r;
+		}
+	};
+
+	//paramSweep runs backtests of a TS over a set of parameters on a work-stealing thread pool. Every run gets its own
+	// backtester and its own copy of the feeder, so the feeder must be cheap to copy and its copies must be safe to replay
+	// concurrently - that's what feeder::sharedHistory and feeder::sharedTimeline are for (the data is parsed once and
+	// shared read-only by all runs). A worker thread reuses its backtester from run to run (see backtester::reset()).
+	// By default every run makes the market anew with the setup() of its own setup object, because the market (e.g.
+	// history sizes of timeframes) may depend on the parameters. If it doesn't, or if there's a setup that suits all
+	// runs, see keepMarket() to make the market only once per worker.
+	// Runs are independent so the throughput scales with the number of threads as long as the memory bandwidth suffices.
+	template<typename TsSetupT>
+	class paramSweep {
+	public:
+		typedef TsSetupT setup_t;
+		typedef backtester<typename setup_t::ct_prms_t::TickersSet_t> backtester_t;
+
+	protected:
+		utils::workStealingPool m_pool;
+		//a backtester per worker thread
+		::std::vector<::std::unique_ptr<backtester_t>> m_bts;
+		//see keepMarket()
+		::std::unique_ptr<const setup_t> m_pMarketSetup;
+
+	public:
+		//nThreads==0 means to use all hardware threads
+		explicit paramSweep(size_t nThreads = 0) : m_pool(nThreads), m_bts(m_pool.size()) {}
+
+		size_t threadsCount()const noexcept { return m_pool.size(); }
+
+		//makes each worker to set up the market once with a copy of so and then to reuse it for all runs
+		// (see backtester::setupMarket() and backtester::reset(true)). so must be the most demanding setup, i.e. its
+		// timeframes must have the longest histories any run needs. Runs don't call setup() then, so setup objects made
+		// by mkSetup must already contain all the runtime parameters the TS needs.
+		void keepMarket(const setup_t& so) {
+			m_pMarketSetup = ::std::make_unique<const setup_t>(so);
+			//backtesters might have markets of other setups
+			for (auto& pBt : m_bts) pBt.reset();
+		}
+		//every run makes its own market (the default)
+		void dontKeepMarket()noexcept {
+			m_pMarketSetup.reset();
+		}
+
+		//mkSetup(const PrmT&) must return a setup_t object for the given parameters and metricsOf(const backtester_t&)
+		// must return a (default constructible) result of a run. Both are called concurrently from worker threads.
+		//Returns results in the order of prms. If a run throws, the first exception is rethrown after all runs are over.
+		template<typename PrmT, typename FeederT, typename SetupFactoryT, typename MetricsF>
+		auto run(const ::std::vector<PrmT>& prms, const FeederT& feed, SetupFactoryT&& mkSetup, MetricsF&& metricsOf) {
+			typedef ::std::decay_t<decltype(metricsOf(::std::declval<const backtester_t&>()))> result_t;
+
+			::std::vector<result_t> res(prms.size());
+			for (size_t i = 0; i < prms.size(); ++i) {
+				m_pool.submit([i, &prms, &feed, &mkSetup, &metricsOf, &res, ths = this]() {
+					setup_t so = mkSetup(prms[i]);
+					//backtester might be big
+					auto& pBt = ths->m_bts[ths->m_pool.workerIndex()];
+					if (pBt) {
+						pBt->reset(!!ths->m_pMarketSetup);
+					} else {
+						pBt = ::std::make_unique<backtester_t>();
+						pBt->silence();
+						if (ths->m_pMarketSetup) {
+							setup_t mso(*ths->m_pMarketSetup);
+							pBt->setupMarket(mso);
+						}
+					}
+					FeederT f(feed);
+					pBt->run(so, f);
+					res[i] = metricsOf(static_cast<const backtester_t&>(*pBt));
+				});
+			}
+			m_pool.wait();
+			return res;
+		}
+
+		template<typename PrmT, typename FeederT, typename SetupFactoryT>
+		::std::vector<sweepMetrics> run(const ::std::vector<PrmT>& prms, const FeederT& feed, SetupFactoryT&& mkSetup) {
+			return run(prms, feed, ::std::forward<SetupFactoryT>(mkSetup), [](const backtester_t& bt) {
+				return sweepMetrics::of(bt);
+			});
+		}
+
+		//the same as run(), but parameters are produced by the generator gen(PrmT&), that returns false when there's no
+		// more parameters. Returns parameters in the order they were generated along with results of the runs
+		template<typename PrmT, typename GenT, typename FeederT, typename SetupFactoryT, typename MetricsF>
+		auto runGenerated(GenT&& gen, const FeederT& feed, SetupFactoryT&& mkSetup, MetricsF&& metricsOf) {
+			::std::vector<PrmT> prms;
+			PrmT p;
+			while (gen(p)) prms.push_back(p);
+			auto res = run(prms, feed, ::std::forward<SetupFactoryT>(mkSetup), ::std::forward<MetricsF>(metricsOf));
+			return ::std::make_pair(::std::move(prms), ::std::move(res));
+		}
+
+		template<typename PrmT, typename GenT, typename FeederT, typename SetupFactoryT>
+		auto runGenerated(GenT&& gen, const FeederT& feed, SetupFactoryT&& mkSetup) {
+			return runGenerated<PrmT>(::std::forward<GenT>(gen), feed, ::std::forward<SetupFactoryT>(mkSetup)
+				, [](const backtester_t& bt) { return sweepMetrics::of(bt); });
+		}
+	};
+
+} }
@@ -0,0 +1,153 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "../market/tickerBase.h"
+#include "../utils/memFootprint.h"
+
+namespace t18 { namespace exec {
+
+	//price levels of some objects (trades, orders), identified by IdT. Levels are grouped by the ticker they are set for
+	// and by the direction of a price move that triggers them. Each group is a flat array sorted by level, therefore
+	// objects triggered by a price range are found with a binary search instead of checking every object.
+	// Levels must be stored as they are compared with prices, see cmpLvl()
+	template<typename IdT>
+	class priceLevels {
+		typedef priceLevels<IdT> self_t;
+	public:
+		typedef tickerBase tickerBase_t;
+		typedef IdT id_t;
+
+	protected:
+		struct entry_t {
+			real_t lvl;
+			id_t id;
+
+			bool operator<(const real_t v)const noexcept { return lvl < v; }
+			friend bool operator<(const real_t v, const entry_t& e)noexcept { return v < e.lvl; }
+		};
+		//sorted by lvl
+		typedef ::std::vector<entry_t> side_t;
+
+		struct tickerLevels {
+			const tickerBase_t* pTickr;
+			side_t fall, rise;
+
+			side_t& sideOf(bool bFall)noexcept { return bFall ? fall : rise; }
+		};
+
+	protected:
+		//there're only a few tickers, so a linear search is fine
+		::std::vector<tickerLevels> m_tickers;
+		size_t m_total = 0;
+
+	protected:
+		tickerLevels& _tickerLevels(const tickerBase_t& Tickr) {
+			for (auto& e : m_tickers) {
+				if (e.pTickr == &Tickr) return e;
+			}
+			m_tickers.push_back(tickerLevels{ &Tickr, side_t(), side_t() });
+			return m_tickers.back();
+		}
+		const tickerLevels* _findTickerLevels(const tickerBase_t& Tickr)const noexcept {
+			for (const auto& e : m_tickers) {
+				if (e.pTickr == &Tickr) return &e;
+			}
+			return nullptr;
+		}
+
+	public:
+		//returns a level to compare with prices of the Tickr. If the ticker snaps prices to its price grid, the level is
+		//snapped too, so a price that is on the level by the data compares equal to it instead of being off by a rounding
+		//error. The comparison itself is still a real_t one
+		static real_t cmpLvl(const tickerBase_t& Tickr, const real_t lvl)noexcept {
+			return Tickr.snapsPricesToTicks() ? Tickr.snapPrice(lvl) : lvl;
+		}
+
+		size_t count()const noexcept { return m_total; }
+
+		//bFall is true for a level triggered by falling prices. Levels that are equal keep the order of insertion
+		void insert(const tickerBase_t& Tickr, bool bFall, real_t lvl, id_t id) {
+			auto& side = _tickerLevels(Tickr).sideOf(bFall);
+			side.insert(::std::upper_bound(side.begin(), side.end(), lvl), entry_t{ lvl, id });
+			++m_total;
+		}
+
+		//arguments must be the same as were passed to insert()
+		void erase(const tickerBase_t& Tickr, bool bFall, real_t lvl, id_t id)noexcept {
+			auto pTl = const_cast<tickerLevels*>(_findTickerLevels(Tickr));
+			if (UNLIKELY(!pTl)) {
+				T18_ASSERT(!"Ticker of the level isn't indexed!");
+				return;
+			}
+			auto& side = pTl->sideOf(bFall);
+			const auto rng = ::std::equal_range(side.begin(), side.end(), lvl);
+			const auto it = ::std::find_if(rng.first, rng.second, [id](const entry_t& e) {return e.id == id; });
+			if (UNLIKELY(it == rng.second)) {
+				T18_ASSERT(!"The level isn't indexed!");
+				return;
+			}
+			side.erase(it);
+			T18_ASSERT(m_total > 0);
+			--m_total;
+		}
+
+		//calls f(id) for every level of the Tickr, that is triggered by a price within [lo, hi]: falling prices trigger
+		// levels >= lo, rising prices trigger levels <= hi. If bInclusive is false, levels equal to lo/hi aren't triggered.
+		// f mustn't change the object
+		template<typename F>
+		void forEachTriggered(const tickerBase_t& Tickr, real_t lo, real_t hi, bool bInclusive, F&& f)const {
+			T18_ASSERT(lo <= hi);
+			const auto* pTl = _findTickerLevels(Tickr);
+			if (!pTl) return;
+
+			const auto& fall = pTl->fall;
+			for (auto it = bInclusive ? ::std::lower_bound(fall.begin(), fall.end(), lo) : ::std::upper_bound(fall.begin(), fall.end(), lo)
+				, e = fall.end(); it != e; ++it)
+			{
+				f(it->id);
+			}
+			const auto& rise = pTl->rise;
+			for (auto it = rise.begin()
+				, e = bInclusive ? ::std::upper_bound(rise.begin(), rise.end(), hi) : ::std::lower_bound(rise.begin(), rise.end(), hi)
+				; it != e; ++it)
+			{
+				f(it->id);
+			}
+		}
+
+		//drops everything keeping the storage allocated
+		void clear()noexcept {
+			for (auto& e : m_tickers) {
+				e.fall.clear();
+				e.rise.clear();
+			}
+			m_total = 0;
+		}
+
+		size_t heapBytes()const noexcept {
+			size_t r = ::utils::heapBytes(m_tickers);
+			for (const auto& e : m_tickers) r += ::utils::heapBytes(e.fall) + ::utils::heapBytes(e.rise);
+			return r;
+		}
+	};
+
+} }
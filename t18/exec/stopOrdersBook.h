@@ -0,0 +1,132 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "iExecTrade.h"
+#include "priceLevels.h"
+
+namespace t18 { namespace exec {
+
+	//pending stop orders. Orders are kept in slots that are recycled using a list of free slots, and their open levels
+	// are indexed by priceLevels: a long stop order is triggered by prices rising above its level, a short one - by
+	// prices falling below it. So the cost of checking a bar is proportional to the number of triggered orders.
+	class stopOrdersBook {
+		typedef stopOrdersBook self_t;
+	public:
+		typedef tickerBase tickerBase_t;
+		typedef size_t slot_t;
+		typedef priceLevels<slot_t> priceLevels_t;
+
+		//an order triggered by a price. seq is the number of the order placement, it tells whether the slot still holds
+		// the same order (a TS may drop orders or place new ones while triggered orders are executed)
+		struct hit_t {
+			size_t seq;
+			slot_t slot;
+
+			bool operator<(const hit_t& r)const noexcept { return seq < r.seq; }
+		};
+
+	protected:
+		struct slotData {
+			OrderData od;
+			real_t lvl;
+			size_t seq;
+		};
+
+	protected:
+		::std::vector<slotData> m_slots;
+		::std::vector<slot_t> m_freeSlots;
+		priceLevels_t m_levels;
+		size_t m_nextSeq = 0;
+
+	public:
+		size_t count()const noexcept { return m_levels.count(); }
+
+		void addNew(OrderData&& od) {
+			T18_ASSERT(!od.is_clean() && od.m_prOpen.isSet());
+			const auto& Tickr = od.m_prOpen.getTicker();
+			const auto lvl = priceLevels_t::cmpLvl(Tickr, od.m_prOpen.getLvl());
+
+			slot_t s;
+			if (m_freeSlots.empty()) {
+				s = m_slots.size();
+				m_slots.emplace_back();
+				//so drop() never reallocates. Following the geometric growth of m_slots keeps the reallocations rare
+				if (m_freeSlots.capacity() < m_slots.size()) m_freeSlots.reserve(m_slots.capacity());
+			} else {
+				s = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+			m_levels.insert(Tickr, !od.m_bLong, lvl, s);
+
+			auto& sd = m_slots[s];
+			T18_ASSERT(sd.od.is_clean());
+			sd.od.set(::std::move(od));
+			sd.lvl = lvl;
+			sd.seq = m_nextSeq++;
+		}
+
+		bool holds(const hit_t& h)const noexcept {
+			//all orders might have been dropped
+			if (h.slot >= m_slots.size()) return false;
+			const auto& sd = m_slots[h.slot];
+			return !sd.od.is_clean() && sd.seq == h.seq;
+		}
+
+		const OrderData& order(slot_t s)const noexcept {
+			T18_ASSERT(s < m_slots.size() && !m_slots[s].od.is_clean());
+			return m_slots[s].od;
+		}
+
+		void drop(slot_t s)noexcept {
+			if (UNLIKELY(s >= m_slots.size() || m_slots[s].od.is_clean())) {
+				T18_ASSERT(!"Invalid slot!");
+				return;
+			}
+			auto& sd = m_slots[s];
+			m_levels.erase(sd.od.m_prOpen.getTicker(), !sd.od.m_bLong, sd.lvl, s);
+			sd.od.clean();
+			T18_ASSERT(m_freeSlots.capacity() > m_freeSlots.size());
+			m_freeSlots.push_back(s);
+		}
+
+		void dropAll()noexcept {
+			m_slots.clear();
+			m_freeSlots.clear();
+			m_levels.clear();
+		}
+
+		//appends to dest orders, which open levels for the Tickr are triggered by a price within [lo, hi]. The orders are
+		// sorted in the order of placement
+		void select(const tickerBase_t& Tickr, real_t lo, real_t hi, ::std::vector<hit_t>& dest)const {
+			const auto first = dest.size();
+			m_levels.forEachTriggered(Tickr, lo, hi, false, [&dest, ths = this](slot_t s) {
+				dest.push_back(hit_t{ ths->m_slots[s].seq, s });
+			});
+			::std::sort(dest.begin() + first, dest.end());
+		}
+
+		size_t heapBytes()const noexcept {
+			return ::utils::heapBytes(m_slots) + ::utils::heapBytes(m_freeSlots) + m_levels.heapBytes();
+		}
+	};
+
+} }
@@ -42,8 +42,7 @@ namespace t18 {
 			typedef typename tradeEx_t::tradeId_t tradeId_t;
 
 			typedef ::std::vector<tradeEx_t> tradeList_t;
-			typedef ::std::list<tradeId_t> tradeOpenList_t;
-			typedef ::std::vector<tradeEx_t*> tradeOpenListHlpr_t;
+			typedef ::std::vector<tradeId_t> tradeOpenList_t;
 
 			//structure to store data necessary for implementation of onTrade*() events
 			template<typename CBT>
@@ -58,17 +57,22 @@ namespace t18 {
 
 		protected:
 			tradeList_t m_trades;
+			//ids of opened trades in the order of opening. Closed trades leave invalid_tid holes, that are removed once
+			// there're more holes than opened trades and nobody iterates over the list
 			tradeOpenList_t m_OpenedTrades;
-			exec_t* m_pTrdExec;
+			//position of a trade in m_OpenedTrades by trade id, _notOpened if it's not there
+			::std::vector<size_t> m_OpenedTradesPos;
+			size_t m_nOpenedTrades = 0;
+			unsigned m_nOpenedTradesIterations = 0;
 
-			tradeOpenListHlpr_t m_OpenedTradesHlpr;
+			exec_t* m_pTrdExec;
 
 			onTradeStatusCBInfoStor_t m_onTradeStatusCBs;
 
 			unsigned m_maxOpenedPositions = ::std::numeric_limits<unsigned>::max();
 
 		public:
-			tradingInterface(exec_t* pE) :m_trades(), m_OpenedTrades(), m_pTrdExec(pE) {}
+			tradingInterface(exec_t* pE) :m_trades(), m_OpenedTrades(), m_OpenedTradesPos(), m_pTrdExec(pE) {}
 
 			void setMaxOpenedPositions(unsigned n)noexcept {
 				T18_ASSERT(n > 0);
@@ -83,7 +87,7 @@ namespace t18 {
 				if (openedTradesCount() >= m_maxOpenedPositions) return nullptr;
 
 				const auto tid = m_trades.size();
-				m_OpenedTrades.push_back(tid);
+				_addTradeToOpenedList(tid);
 
 				//creating tradeEx_t object
 				m_trades.emplace_back(m_pTrdExec, tid, trade_t::TSQ4market(bLong ? Tickr.getBestAsk() : Tickr.getBestBid())
@@ -106,25 +110,85 @@ namespace t18 {
 				return newMarketTrade(false, ::std::forward<TradeTArgs>(ttargs)...);
 			}
 
-			size_t openedTradesCount()const noexcept { return m_OpenedTrades.size(); }
+			size_t openedTradesCount()const noexcept { return m_nOpenedTrades; }
+
+			::utils::memFootprint memoryFootprint(const char* name = "tradingInterface")const {
+				::utils::memFootprint r(name, sizeof(self_t) + ::utils::heapBytes(m_onTradeStatusCBs));
+				r.add("trades", ::utils::heapBytes(m_trades));
+				r.add("openedTrades", ::utils::heapBytes(m_OpenedTrades) + ::utils::heapBytes(m_OpenedTradesPos));
+				return r;
+			}
+
+		protected:
+			//drops all trades keeping the storage allocated for them. Trade status subscribers must be gone already
+			void _reset()noexcept {
+				T18_ASSERT(m_onTradeStatusCBs.empty() || !"Trade status subscribers mustn't outlive a run");
+				T18_ASSERT(!m_nOpenedTradesIterations);
+				m_trades.clear();
+				m_OpenedTrades.clear();
+				m_OpenedTradesPos.clear();
+				m_nOpenedTrades = 0;
+			}
+
 		private:
+			static constexpr size_t _notOpened = ::std::numeric_limits<size_t>::max();
+
+			//marks a running iteration over m_OpenedTrades, so the list isn't compacted under it
+			struct _openedTradesIteration {
+				self_t& ti;
+
+				_openedTradesIteration(self_t& t)noexcept : ti(t) { ++ti.m_nOpenedTradesIterations; }
+				~_openedTradesIteration() {
+					T18_ASSERT(ti.m_nOpenedTradesIterations > 0);
+					if (0 == --ti.m_nOpenedTradesIterations) ti._compactOpenedList();
+				}
+			};
+
+			void _addTradeToOpenedList(tradeId_t tid) {
+				if (m_OpenedTradesPos.size() <= tid) m_OpenedTradesPos.resize(tid + 1, _notOpened);
+				T18_ASSERT(_notOpened == m_OpenedTradesPos[tid]);
+				m_OpenedTrades.push_back(tid);
+				m_OpenedTradesPos[tid] = m_OpenedTrades.size() - 1;
+				++m_nOpenedTrades;
+			}
+
+			void _compactOpenedList()noexcept {
+				T18_ASSERT(m_OpenedTrades.size() >= m_nOpenedTrades);
+				if (m_nOpenedTradesIterations || m_OpenedTrades.size() - m_nOpenedTrades <= m_nOpenedTrades) return;
+
+				size_t n = 0;
+				for (const auto tid : m_OpenedTrades) {
+					if (tid != trade_t::invalid_tid) {
+						m_OpenedTradesPos[tid] = n;
+						m_OpenedTrades[n++] = tid;
+					}
+				}
+				T18_ASSERT(n == m_nOpenedTrades);
+				m_OpenedTrades.resize(n);
+			}
+
 			void _removeTradeFromOpenedList(const trade_t& trd)noexcept {
 				T18_ASSERT(!trd.is_SomethingInMarket());
 
-				auto it = ::std::find(m_OpenedTrades.begin(), m_OpenedTrades.end(), trd.TradeId());
-				if (it == m_OpenedTrades.end()) {
+				const auto tid = trd.TradeId();
+				if (!_isTradeInOpenedList(trd)) {
 					//#todo log!
 					T18_ASSERT(!"_removeTradeFromOpenedList: No such trade to close!");
 					//throw ::std::runtime_error("_markTradeClosed: No such trade to close!");
 					//no point to throw here
 				} else {
-					m_OpenedTrades.erase(it);
+					auto& pos = m_OpenedTradesPos[tid];
+					T18_ASSERT(m_OpenedTrades[pos] == tid && m_nOpenedTrades > 0);
+					m_OpenedTrades[pos] = trade_t::invalid_tid;
+					pos = _notOpened;
+					--m_nOpenedTrades;
+					_compactOpenedList();
 				}
 			}
 
 			bool _isTradeInOpenedList(const trade_t& trd)const noexcept {
-				auto it = ::std::find(m_OpenedTrades.begin(), m_OpenedTrades.end(), trd.TradeId());
-				return it != m_OpenedTrades.end();
+				const auto tid = trd.TradeId();
+				return tid < m_OpenedTradesPos.size() && _notOpened != m_OpenedTradesPos[tid];
 			}
 
 		public:
@@ -271,6 +335,7 @@ namespace t18 {
 			/////////////////////////////////////////////////////////////////////////////////
 		protected:
 			//during execution of _any_ forEach*() routine it is safe to close a trade, but NOT safe to open new trade
+			// (forEachOpenedTrade*() routines allow that, though new trades aren't visited)
 
 			template<typename TradeT, typename F>
 			void _forEachTradeT(F&& f) {
@@ -303,53 +368,33 @@ namespace t18 {
 			}
 
 
-			template<typename TradeT, typename F>
-			void _execOpenedTradesHlpr(F&& f) {
-				for (auto t : m_OpenedTradesHlpr) {
-					::std::forward<F>(f)(*static_cast<TradeT*>(t));
-				}
-				m_OpenedTradesHlpr.clear();
-			}
-
 			template<typename TradeT, typename F>
 			void _forEachOpenedTradeT(F&& f) {
-				//m_OpenedTrades container might be changed as a result of applying f, so we have to workaround it
-				const auto otc = m_OpenedTrades.size();
-				if (otc) {
-					T18_ASSERT(!m_OpenedTradesHlpr.size());
-					if (m_OpenedTradesHlpr.capacity() < otc) m_OpenedTradesHlpr.reserve(otc);
-
-					for (auto tid : m_OpenedTrades) {
-						auto& t = getTradeEx(tid);
+				_openedTradesIteration oti(*this);
+				//trades opened by f are not visited, trades closed by f are skipped
+				for (size_t i = 0, n = m_OpenedTrades.size(); i < n; ++i) {
+					const auto tid = m_OpenedTrades[i];
+					if (tid != trade_t::invalid_tid) {
+						TradeT& t = getTradeEx(tid);
 						T18_ASSERT(!t.is_Closed() && !t.is_Failed());
-						m_OpenedTradesHlpr.push_back(&t);
-					}
-
-					if (m_OpenedTradesHlpr.size()) {
-						_execOpenedTradesHlpr<TradeT>(::std::forward<F>(f));
+						::std::forward<F>(f)(t);
 					}
 				}
 			}
 
 			template<typename TradeT, typename F>
 			void _forEachOpenedTradeT(const tickerBase_t& Tickr, F&& f) {
-				//m_OpenedTrades container might be changed as a result of applying f, so we have to workaround it
-				const auto otc = m_OpenedTrades.size();
-				if (otc) {
-					T18_ASSERT(!m_OpenedTradesHlpr.size());
-					if (m_OpenedTradesHlpr.capacity() < otc) m_OpenedTradesHlpr.reserve(otc);
-
-					for (auto tid : m_OpenedTrades) {
-						auto& t = getTradeEx(tid);
+				_openedTradesIteration oti(*this);
+				//trades opened by f are not visited, trades closed by f are skipped
+				for (size_t i = 0, n = m_OpenedTrades.size(); i < n; ++i) {
+					const auto tid = m_OpenedTrades[i];
+					if (tid != trade_t::invalid_tid) {
+						TradeT& t = getTradeEx(tid);
 						T18_ASSERT(!t.is_Closed() && !t.is_Failed());
 						if (Tickr == t.Ticker()) {
-							m_OpenedTradesHlpr.push_back(&t);
+							::std::forward<F>(f)(t);
 						}
 					}
-
-					if (m_OpenedTradesHlpr.size()) {
-						_execOpenedTradesHlpr<TradeT>(::std::forward<F>(f));
-					}
 				}
 			}
 
@@ -410,9 +455,11 @@ namespace t18 {
 			template<typename F>
 			void forEachOpenedTrade(F&& f) const {
 				for (auto tid : m_OpenedTrades) {
-					const auto& t = getTrade(tid);
-					T18_ASSERT(!t.is_Closed() && !t.is_Failed());
-					::std::forward<F>(f)(t);
+					if (tid != trade_t::invalid_tid) {
+						const auto& t = getTrade(tid);
+						T18_ASSERT(!t.is_Closed() && !t.is_Failed());
+						::std::forward<F>(f)(t);
+					}
 				}
 			}
 
@@ -433,10 +480,12 @@ namespace t18 {
 			template<typename F>
 			void forEachOpenedTrade(const tickerBase_t& Tickr, F&& f) const {
 				for (auto tid : m_OpenedTrades) {
-					const auto& t = getTrade(tid);
-					T18_ASSERT(!t.is_Closed() && !t.is_Failed());
-					if (Tickr == t.Ticker()) {
-						::std::forward<F>(f)(t);
+					if (tid != trade_t::invalid_tid) {
+						const auto& t = getTrade(tid);
+						T18_ASSERT(!t.is_Closed() && !t.is_Failed());
+						if (Tickr == t.Ticker()) {
+							::std::forward<F>(f)(t);
+						}
 					}
 				}
 			}
@@ -451,9 +500,11 @@ namespace t18 {
 
 			bool anyOpenedTrades4Ticker(const tickerBase_t& Tickr)const noexcept {
 				for (const auto tid : m_OpenedTrades) {
-					const auto& t = getTrade(tid);
-					T18_ASSERT(!t.is_Closed() && !t.is_Failed());
-					if (Tickr == t.Ticker()) return true;
+					if (tid != trade_t::invalid_tid) {
+						const auto& t = getTrade(tid);
+						T18_ASSERT(!t.is_Closed() && !t.is_Failed());
+						if (Tickr == t.Ticker()) return true;
+					}
 				}
 				return false;
 				/*return ::std::any_of(m_OpenedTrades.cbegin(), m_OpenedTrades.cend(), [&Tickr](const auto tid) {
@@ -547,7 +598,8 @@ namespace t18 {
 			}
 
 			static const char* moneyVal2str(money_t v)noexcept {
-				static char buf[32];
+				//concurrent backtests (see paramSweep) may report at the same time
+				static thread_local char buf[32];
 				sprintf_s(buf, "%.2f", v);
 				return buf;
 			}
@@ -0,0 +1,66 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+// compile time properties of feeder adapters
+
+#include <type_traits>
+
+#include "../utils/myFile.h"
+
+namespace t18 {
+	namespace feeder {
+
+		namespace _i {
+			//an adapter may declare a file_t type to be used instead of utils::myFile to read data files
+			template<typename AdptT, typename = void>
+			struct adapterFile {
+				typedef utils::myFile type;
+			};
+			template<typename AdptT>
+			struct adapterFile<AdptT, ::std::void_t<typename AdptT::file_t>> {
+				typedef typename AdptT::file_t type;
+			};
+
+			//an adapter may declare an index_t type, that describes a data file to size it and to seek to a timestamp
+			// (see adapters::csvIndex)
+			template<typename AdptT, typename = void>
+			struct adapterHasIndex : ::std::false_type {};
+			template<typename AdptT>
+			struct adapterHasIndex<AdptT, ::std::void_t<typename AdptT::index_t>> : ::std::true_type {};
+
+			struct noIndex {};
+			template<typename AdptT, typename = void>
+			struct adapterIndex {
+				typedef noIndex type;
+			};
+			template<typename AdptT>
+			struct adapterIndex<AdptT, ::std::void_t<typename AdptT::index_t>> {
+				typedef typename AdptT::index_t type;
+			};
+		}
+		template<typename AdptT>
+		using adapterFile_t = typename _i::adapterFile<::std::decay_t<AdptT>>::type;
+		template<typename AdptT>
+		inline constexpr bool adapterHasIndex_v = _i::adapterHasIndex<::std::decay_t<AdptT>>::value;
+		//adapter's index_t or an empty placeholder type if the adapter has no index
+		template<typename AdptT>
+		using adapterIndex_t = typename _i::adapterIndex<::std::decay_t<AdptT>>::type;
+
+	}
+}
@@ -158,6 +158,34 @@ namespace t18 {
 				}
 			};
 
+			//reads the same format as csv_tsTick, but keeps the deal number and the aggressor side (see tsDeal).
+			//A ticker stores them only if it has the deals history enabled (see tickerServer::enableDealsHistory())
+			struct csv_tsDeal : public csv_tsTick {
+				typedef tsDeal value_t;
+			private:
+				typedef csv_tsTick base_class_t;
+
+			public:
+				static bool readNext(FILE* hF, value_t& val, int& nRead)noexcept {
+					date_ult d;
+					time_ult t;
+					::std::int32_t bIsLong;
+
+					nRead = fscanf_s(hF, csvFormat.c_str(), &d, &t, &val.q, &val.v, &val.dealNum, &bIsLong);
+					const bool bRead = (nRead == numOfCsvElements);
+					if (LIKELY(bRead)) {
+						val.TS() = mxTimestamp(tag_milDT(), d, t);
+						val.bLong = (0 != bIsLong);
+					}
+					return bRead;
+				}
+
+				template<typename MdssT, typename TickerServT>
+				static void updateMkt(MdssT& Mkt, TickerServT& Tickr, const value_t& val) noexcept {
+					Mkt.newTick(Tickr, val);
+				}
+			};
+
 			//////////////////////////////////////////////////////////////////////////
 
 
@@ -0,0 +1,460 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+//fastCsv adapters read exactly the same csv formats as the adapters from csv.h, but instead of per-record fscanf_s
+//calls they read the file by large blocks (utils::blockFile), split it into lines with memchr, parse numbers with
+//::std::from_chars (locale independent) and decode YYYYMMDD,HHMMSS date/time fields directly from the digits.
+//The adapters declare file_t, so feeders open data files with utils::blockFile instead of utils::myFile, and index_t,
+//so feeders could size the data and seek to a timestamp using the sidecar index (see csvIndex)
+
+#include <charconv>
+#include <vector>
+#include <algorithm>
+
+#include "csv.h"
+#include "../../utils/blockFile.h"
+
+namespace t18 {
+	namespace feeder {
+		namespace adapters {
+
+			namespace _i {
+
+				//parses fields of a single csv record in place. Leading whitespace of a field is skipped as fscanf does
+				class csvRecParser {
+				protected:
+					const char* m_p;
+					const char*const m_e;
+					int m_n = 0;//count of fields parsed
+
+				protected:
+					static constexpr bool _isWs(char c)noexcept { return ' ' == c || '\t' == c || '\r' == c; }
+					static constexpr bool _isDigit(char c)noexcept { return c >= '0' && c <= '9'; }
+					static constexpr int _d(const char* p)noexcept { return p[0] - '0'; }
+					static constexpr int _dd(const char* p)noexcept { return (p[0] - '0') * 10 + (p[1] - '0'); }
+
+					//ranges of the fields that milDate::untie_mildate() and milTime::untie_miltime() expect
+					static constexpr bool _validDT(int y, int m, int d, int h, int mn, int s)noexcept {
+						return y > 1900 && y < 2100 && m > 0 && m <= 12 && d > 0 && d <= _uglyTime::daysInMonth(m, _uglyTime::isLeapYear(y))
+							&& h >= 0 && h <= 23 && mn >= 0 && mn <= 59 && s >= 0 && s <= 59;
+					}
+
+					void _skipWs()noexcept {
+						while (m_p < m_e && _isWs(*m_p)) ++m_p;
+					}
+
+					template<typename T>
+					bool _digits(T& v)noexcept {
+						if (UNLIKELY(m_p >= m_e || !_isDigit(*m_p))) return false;
+						T r = 0;
+						do {
+							r = r * 10 + static_cast<T>(*m_p - '0');
+						} while (++m_p < m_e && _isDigit(*m_p));
+						v = r;
+						return true;
+					}
+
+				public:
+					csvRecParser(const char* b, const char* e)noexcept : m_p(b), m_e(e) {}
+
+					int parsed()const noexcept { return m_n; }
+
+					//reads the next non blank line of the file
+					static bool nextRecord(utils::blockFile& f, const char*& b, const char*& e) {
+						while (f.nextLine(b, e)) {
+							while (b < e && _isWs(*b)) ++b;
+							if (b < e) return true;
+						}
+						return false;
+					}
+
+					template<typename T>
+					bool uint(T& v)noexcept {
+						static_assert(::std::is_unsigned_v<T>, "");
+						_skipWs();
+						if (m_p < m_e && '+' == *m_p) ++m_p;
+						if (UNLIKELY(!_digits(v))) return false;
+						++m_n;
+						return true;
+					}
+					template<typename T>
+					bool sint(T& v)noexcept {
+						static_assert(::std::is_signed_v<T>, "");
+						_skipWs();
+						const bool bNeg = m_p < m_e && '-' == *m_p;
+						if (m_p < m_e && ('-' == *m_p || '+' == *m_p)) ++m_p;
+						if (UNLIKELY(!_digits(v))) return false;
+						if (bNeg) v = -v;
+						++m_n;
+						return true;
+					}
+					template<typename T>
+					bool real(T& v)noexcept {
+						static_assert(::std::is_floating_point_v<T>, "");
+						_skipWs();
+						if (m_p < m_e && '+' == *m_p) ++m_p;
+						const auto r = ::std::from_chars(m_p, m_e, v);
+						if (UNLIKELY(r.ec != ::std::errc())) return false;
+						m_p = r.ptr;
+						++m_n;
+						return true;
+					}
+
+					bool sep()noexcept {
+						if (LIKELY(m_p < m_e && ',' == *m_p)) {
+							++m_p;
+							return true;
+						}
+						return false;
+					}
+					bool end()noexcept {
+						_skipWs();
+						return m_p == m_e;
+					}
+
+					//date and time fields in the same format as tag_milDT constructor of mxTimestamp takes.
+					//The usual 8 digits date and 6 digits time are decoded directly from the digits. Returns false if
+					// a field is out of its range (for example, the 13th month or the 61st second)
+					bool milDT(mxTimestamp& ts)noexcept {
+						_skipWs();
+						const char*const pD = m_p;
+						date_ult d;
+						if (UNLIKELY(!_digits(d))) return false;
+						const bool bFixedDate = (m_p - pD == 8);
+						++m_n;
+						if (UNLIKELY(!sep())) return false;
+
+						_skipWs();
+						const char*const pT = m_p;
+						time_ult t;
+						if (UNLIKELY(!_digits(t))) return false;
+						++m_n;
+
+						int y, m, dd, h, mn, s;
+						if (LIKELY(bFixedDate && m_p - pT == 6)) {
+							y = _dd(pD) * 100 + _dd(pD + 2);
+							m = _dd(pD + 4);
+							dd = _dd(pD + 6);
+							h = _dd(pT);
+							mn = _dd(pT + 2);
+							s = _dd(pT + 4);
+						} else {
+							if (UNLIKELY(d > 99999999 || t > 999999)) return false;
+							y = static_cast<int>(d / 10000);
+							m = static_cast<int>(d / 100 % 100);
+							dd = static_cast<int>(d % 100);
+							h = static_cast<int>(t / 10000);
+							mn = static_cast<int>(t / 100 % 100);
+							s = static_cast<int>(t % 100);
+						}
+						if (UNLIKELY(!_validDT(y, m, dd, h, mn, s))) return false;
+						ts = mxTimestamp(y, m, dd, h, mn, s);
+						return true;
+					}
+				};
+			}
+
+
+			//////////////////////////////////////////////////////////////////////////
+			//csvIndex describes a csv file, that starts its records with date and time fields: the count of records, the first
+			//and the last timestamps and a sparse table of timestamps and byte offsets of every m_step-th record.
+			//The index is stored in a sidecar file (the data file name + sidecarExt) and is validated against the size and
+			//the last write time of the data file, so it's built only once per a data file version.
+			class csvIndex {
+			public:
+				static constexpr auto sidecarExt = ".t18idx";
+				static constexpr size_t defaultStep = 1024;
+
+				struct entry {
+					timestamp_ult ts;
+					::std::uint64_t ofs;
+				};
+
+			protected:
+				struct header {
+					char magic[8];
+					::std::uint64_t version;
+					::std::uint64_t fileSize;
+					::std::int64_t mtime;
+					::std::uint64_t count;
+					timestamp_ult firstTs;
+					timestamp_ult lastTs;
+					::std::uint64_t step;
+					::std::uint64_t nEntries;
+				};
+				static constexpr char magic_v[8] = { 't','1','8','i','d','x','\0','\0' };
+				static constexpr ::std::uint64_t version_v = 1;
+
+			protected:
+				header m_hdr;
+				::std::vector<entry> m_entries;
+
+			protected:
+				//returns an index of the last entry with ts < from, or 0 if there's no such entry
+				size_t _entryBefore(mxTimestamp from)const noexcept {
+					const auto it = ::std::lower_bound(m_entries.begin(), m_entries.end(), from._get()
+						, [](const entry& e, timestamp_ult t)noexcept { return e.ts < t; });
+					return it == m_entries.begin() ? 0 : static_cast<size_t>(it - m_entries.begin()) - 1;
+				}
+
+			public:
+				csvIndex()noexcept {
+					::std::memset(&m_hdr, 0, sizeof(m_hdr));
+				}
+
+				size_t count()const noexcept { return static_cast<size_t>(m_hdr.count); }
+				bool empty()const noexcept { return 0 == m_hdr.count; }
+				size_t step()const noexcept { return static_cast<size_t>(m_hdr.step); }
+				mxTimestamp firstTs()const noexcept { return mxTimestamp(m_hdr.firstTs); }
+				mxTimestamp lastTs()const noexcept { return mxTimestamp(m_hdr.lastTs); }
+				const ::std::vector<entry>& entries()const noexcept { return m_entries; }
+
+				//byte offset of a record, from which reading should start to get every record with timestamp >= from
+				::std::uint64_t offsetBefore(mxTimestamp from)const noexcept {
+					return m_entries.empty() ? 0 : m_entries[_entryBefore(from)].ofs;
+				}
+
+				//upper bound of count of records with timestamps in [from, to). Empty from or to means an open range
+				size_t countUpperBound(mxTimestamp from, mxTimestamp to)const noexcept {
+					if (m_entries.empty()) return count();
+					const size_t lo = from.empty() ? 0 : _entryBefore(from) * step();
+					size_t hi = count();
+					if (!to.empty()) {
+						const auto it = ::std::lower_bound(m_entries.begin(), m_entries.end(), to._get()
+							, [](const entry& e, timestamp_ult t)noexcept { return e.ts < t; });
+						if (it != m_entries.end()) hi = ::std::min(hi, static_cast<size_t>(it - m_entries.begin()) * step());
+					}
+					return hi > lo ? hi - lo : 0;
+				}
+
+				//reads the whole data file
+				static csvIndex build(const char* fname, size_t step = defaultStep) {
+					T18_ASSERT(step > 0);
+					csvIndex r;
+					::std::memcpy(r.m_hdr.magic, magic_v, sizeof(magic_v));
+					r.m_hdr.version = version_v;
+					r.m_hdr.step = step;
+					utils::myFile::stamp(fname, r.m_hdr.fileSize, r.m_hdr.mtime);
+
+					utils::blockFile f(fname);
+					const char *b, *e;
+					mxTimestamp ts;
+					size_t n = 0;
+					while (_i::csvRecParser::nextRecord(f, b, e)) {
+						_i::csvRecParser p(b, e);
+						if (UNLIKELY(!p.milDT(ts))) {
+							T18_ASSERT(!"Failed to read a timestamp of a record");
+							throw ::std::runtime_error("csvIndex: failed to read a timestamp of the record #"s + ::std::to_string(n + 1)
+								+ " of " + fname);
+						}
+						if (0 == n) r.m_hdr.firstTs = ts._get();
+						if (0 == n % step) r.m_entries.push_back(entry{ ts._get(), f.offsetOf(b) });
+						r.m_hdr.lastTs = ts._get();
+						++n;
+					}
+					r.m_hdr.count = n;
+					r.m_hdr.nEntries = r.m_entries.size();
+					return r;
+				}
+
+				//loads the index from the sidecar file. Returns false if there's no valid index for the current data file
+				bool load(const char* fname) {
+					const ::std::string sc(::std::string(fname) + sidecarExt);
+					if (!utils::myFile::exist(sc.c_str())) return false;
+
+					::std::uint64_t fileSize;
+					::std::int64_t mtime;
+					utils::myFile::stamp(fname, fileSize, mtime);
+
+					utils::myFile f(sc.c_str(), "rb");
+					header h;
+					if (1 != fread(&h, sizeof(h), 1, f) || 0 != ::std::memcmp(h.magic, magic_v, sizeof(magic_v))
+						|| version_v != h.version || fileSize != h.fileSize || mtime != h.mtime || 0 == h.step
+						|| h.nEntries != (h.count + h.step - 1) / h.step)
+					{
+						return false;
+					}
+					::std::vector<entry> ents(static_cast<size_t>(h.nEntries));
+					if (h.nEntries && 1 != fread(ents.data(), sizeof(entry) * ents.size(), 1, f)) return false;
+
+					m_hdr = h;
+					m_entries = ::std::move(ents);
+					return true;
+				}
+
+				void save(const char* fname)const {
+					const ::std::string sc(::std::string(fname) + sidecarExt);
+					utils::myFile f(sc.c_str(), "wb");
+					if (1 != fwrite(&m_hdr, sizeof(m_hdr), 1, f)
+						|| (!m_entries.empty() && 1 != fwrite(m_entries.data(), sizeof(entry) * m_entries.size(), 1, f)))
+					{
+						T18_ASSERT(!"Failed to write the index");
+						throw ::std::runtime_error("Failed to write the index " + sc);
+					}
+				}
+
+				//loads a valid index of the data file or builds and saves a new one. Failure to save the sidecar isn't an
+				//error (the directory may be read-only), the index is just rebuilt next time
+				static csvIndex forFile(const char* fname, size_t step = defaultStep) {
+					csvIndex r;
+					if (!r.load(fname)) {
+						r = build(fname, step);
+						try {
+							r.save(fname);
+						} catch (const ::std::exception&) {
+							//#todo write log!
+						}
+					}
+					return r;
+				}
+			};
+
+			//////////////////////////////////////////////////////////////////////////
+
+			struct fastCsv_tsohlcv : public csv_tsohlcv {
+				typedef utils::blockFile file_t;
+				typedef csvIndex index_t;
+
+				static size_t capacity(const char* fname) {
+					return index_t::forFile(fname).count();
+				}
+
+				//parses a single record [b, e) without the line ending
+				static bool parseRecord(const char* b, const char* e, value_t& val, int& nRead)noexcept {
+					_i::csvRecParser p(b, e);
+					const bool bRead = p.milDT(val.TS()) && p.sep() && p.real(val.o()) && p.sep() && p.real(val.h) && p.sep()
+						&& p.real(val.l) && p.sep() && p.real(val.c) && p.sep() && p.real(val.v) && p.end();
+					nRead = p.parsed();
+					return bRead;
+				}
+
+				static bool readNext(file_t& f, value_t& val, int& nRead) {
+					const char *b, *e;
+					if (!_i::csvRecParser::nextRecord(f, b, e)) {
+						nRead = EOF;
+						return false;
+					}
+					return parseRecord(b, e, val, nRead);
+				}
+			};
+
+			struct fastCsv_tsTick : public csv_tsTick {
+				typedef utils::blockFile file_t;
+				typedef csvIndex index_t;
+
+				static size_t capacity(const char* fname) {
+					return index_t::forFile(fname).count();
+				}
+
+				static bool parseRecord(const char* b, const char* e, value_t& val, int& nRead)noexcept {
+					dealnum_t dealNum;
+					::std::int32_t bIsLong;
+
+					_i::csvRecParser p(b, e);
+					const bool bRead = p.milDT(val.TS()) && p.sep() && p.real(val.q) && p.sep() && p.real(val.v) && p.sep()
+						&& p.uint(dealNum) && p.sep() && p.sint(bIsLong) && p.end();
+					nRead = p.parsed();
+					return bRead;
+				}
+
+				static bool readNext(file_t& f, value_t& val, int& nRead) {
+					const char *b, *e;
+					if (!_i::csvRecParser::nextRecord(f, b, e)) {
+						nRead = EOF;
+						return false;
+					}
+					return parseRecord(b, e, val, nRead);
+				}
+			};
+
+			struct fastCsv_tsDeal : public csv_tsDeal {
+				typedef utils::blockFile file_t;
+				typedef csvIndex index_t;
+
+				static size_t capacity(const char* fname) {
+					return index_t::forFile(fname).count();
+				}
+
+				static bool parseRecord(const char* b, const char* e, value_t& val, int& nRead)noexcept {
+					::std::int32_t bIsLong;
+
+					_i::csvRecParser p(b, e);
+					const bool bRead = p.milDT(val.TS()) && p.sep() && p.real(val.q) && p.sep() && p.real(val.v) && p.sep()
+						&& p.uint(val.dealNum) && p.sep() && p.sint(bIsLong) && p.end();
+					nRead = p.parsed();
+					if (LIKELY(bRead)) val.bLong = (0 != bIsLong);
+					return bRead;
+				}
+
+				static bool readNext(file_t& f, value_t& val, int& nRead) {
+					const char *b, *e;
+					if (!_i::csvRecParser::nextRecord(f, b, e)) {
+						nRead = EOF;
+						return false;
+					}
+					return parseRecord(b, e, val, nRead);
+				}
+			};
+
+			//#WARNING the same as csv_tsq, it's not a full-featured adapter
+			struct fastCsv_tsq : public csv_tsq {
+				typedef utils::blockFile file_t;
+				typedef csvIndex index_t;
+
+				static size_t capacity(const char* fname) {
+					return index_t::forFile(fname).count();
+				}
+
+				static bool parseRecord(const char* b, const char* e, value_t& val, int& nRead)noexcept {
+					_i::csvRecParser p(b, e);
+					const bool bRead = p.milDT(val.TS()) && p.sep() && p.real(val.q) && p.end();
+					nRead = p.parsed();
+					return bRead;
+				}
+
+				static bool readNext(file_t& f, value_t& val, int& nRead) {
+					const char *b, *e;
+					if (!_i::csvRecParser::nextRecord(f, b, e)) {
+						nRead = EOF;
+						return false;
+					}
+					return parseRecord(b, e, val, nRead);
+				}
+			};
+
+			//makes the adapter AdptT to read the data with nBlocks blocks prefetched by a dedicated thread, see
+			// utils::blockFile::setPrefetch()
+			template<typename AdptT, size_t nBlocks = 4>
+			struct prefetching : public AdptT {
+				static_assert(nBlocks > 0, "");
+
+				class file_t : public utils::blockFile {
+				public:
+					file_t() : blockFile() {
+						setPrefetch(nBlocks);
+					}
+					file_t(const char*const fname, const char*const fmode = "rb") : blockFile() {
+						setPrefetch(nBlocks);
+						open(fname, fmode);
+					}
+				};
+			};
+		}
+	}
+}
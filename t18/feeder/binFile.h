@@ -0,0 +1,384 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "../base.h"
+#include "../tags.h"
+#include "../utils/myFile.h"
+#include "../utils/mappedFile.h"
+#include "../utils/decompressor.h"
+#include "memory.h"
+#include "singleFile.h"
+
+namespace t18 {
+	namespace feeder {
+
+		//binFile is a binary columnar file format for bars (tsohlcv) and ticks (tsTick) that is read with zero parsing.
+		//Layout: binFileHeader followed by fixed-width columns (timestamps as raw mxTimestamp values, then prices and the
+		// volume), each one starting at a 64-bytes aligned offset. The file is memory mapped, so the load is bound by the
+		// page faults only and every record is built directly from the columns when it's fed to a ticker.
+		//Files are produced by binFile::write() or by binFile::convert() from any source supported by singleFile adapters.
+		//Note that the columns store the raw real_t/volume_t values, so the file is usable only by the builds with the
+		// same types (this is checked on opening)
+		struct binFileHeader {
+			static constexpr char magic_v[8] = { 't','1','8','b','i','n','\0','\0' };
+			static constexpr ::std::uint32_t version_v = 1;
+			static constexpr size_t maxColumns = 6;
+			static constexpr size_t tickerLen = 32;
+
+			char magic[8];
+			::std::uint32_t version;
+			::std::uint32_t kind;//see _i::binFileCols<>::kind
+			::std::uint32_t realSize;
+			::std::uint32_t volumeSize;
+			::std::uint32_t tfMinutes;//timeframe of bars, 0 for ticks or when unknown
+			::std::uint32_t nColumns;
+			::std::uint64_t count;
+			timestamp_ult firstTs;
+			timestamp_ult lastTs;
+			char ticker[tickerLen];//zero terminated
+			::std::uint64_t colOffs[maxColumns];//offsets of columns from the beginning of the file
+		};
+		static_assert(sizeof(binFileHeader) == 136 && ::std::is_trivially_copyable_v<binFileHeader>, "");
+
+		namespace _i {
+			inline constexpr size_t binFileAlign = 64;
+
+			template<typename ValT> struct binFileCols;
+
+			template<> struct binFileCols<tsohlcv> {
+				static constexpr ::std::uint32_t kind = 1;
+				static constexpr size_t nPrices = 4;
+
+				static real_t price(const tsohlcv& b, size_t k)noexcept {
+					T18_ASSERT(k < nPrices);
+					return 0 == k ? b.o() : (1 == k ? b.h : (2 == k ? b.l : b.c));
+				}
+				static tsohlcv make(timestamp_ult ts, const real_t*const* pr, const volume_t* v, size_t i)noexcept {
+					return tsohlcv(mxTimestamp(ts), pr[0][i], pr[1][i], pr[2][i], pr[3][i], v[i]);
+				}
+			};
+
+			template<> struct binFileCols<tsTick> {
+				static constexpr ::std::uint32_t kind = 2;
+				static constexpr size_t nPrices = 1;
+
+				static real_t price(const tsTick& t, size_t k)noexcept {
+					T18_ASSERT(0 == k);
+					return t.q;
+				}
+				static tsTick make(timestamp_ult ts, const real_t*const* pr, const volume_t* v, size_t i)noexcept {
+					return tsTick(mxTimestamp(ts), pr[0][i], v[i]);
+				}
+			};
+		}
+
+		template<typename ValT>
+		class binFile {
+		public:
+			typedef ValT value_type;
+			typedef binFile<value_type> self_t;
+			typedef _i::binFileCols<value_type> cols_t;
+
+			static constexpr bool bTicks = ::std::is_base_of_v<tsTick, value_type>;
+			static constexpr size_t nColumns = cols_t::nPrices + 2;
+			static_assert(nColumns <= binFileHeader::maxColumns, "");
+
+		protected:
+			utils::mappedFile m_file;
+			//the whole content of a compressed file, that is used instead of the mapping
+			::std::vector<::std::uint8_t> m_unpacked;
+			const ::std::uint8_t* m_pData = nullptr;
+			size_t m_dataSize = 0;
+			bool m_bOpened = false;
+
+			binFileHeader m_hdr;
+
+			const timestamp_ult* m_pTs = nullptr;
+			const real_t* m_pPrices[cols_t::nPrices];
+			const volume_t* m_pVol = nullptr;
+
+		protected:
+			static constexpr size_t _align(size_t v)noexcept {
+				return (v + _i::binFileAlign - 1) / _i::binFileAlign * _i::binFileAlign;
+			}
+
+			static binFileHeader _makeHeader(size_t n, const char* ticker, unsigned tfMinutes)noexcept {
+				binFileHeader h;
+				::std::memset(&h, 0, sizeof(h));
+				::std::memcpy(h.magic, binFileHeader::magic_v, sizeof(h.magic));
+				h.version = binFileHeader::version_v;
+				h.kind = cols_t::kind;
+				h.realSize = static_cast<::std::uint32_t>(sizeof(real_t));
+				h.volumeSize = static_cast<::std::uint32_t>(sizeof(volume_t));
+				h.tfMinutes = tfMinutes;
+				h.nColumns = static_cast<::std::uint32_t>(nColumns);
+				h.count = n;
+				if (ticker) {
+					const auto l = ::std::min(::std::strlen(ticker), binFileHeader::tickerLen - 1);
+					::std::memcpy(h.ticker, ticker, l);
+				}
+				size_t off = _align(sizeof(binFileHeader));
+				h.colOffs[0] = off;
+				off = _align(off + n * sizeof(timestamp_ult));
+				for (size_t k = 0; k < cols_t::nPrices; ++k) {
+					h.colOffs[k + 1] = off;
+					off = _align(off + n * sizeof(real_t));
+				}
+				h.colOffs[nColumns - 1] = off;
+				return h;
+			}
+
+			static size_t _fileSize(const binFileHeader& h)noexcept {
+				return static_cast<size_t>(h.colOffs[nColumns - 1] + h.count * sizeof(volume_t));
+			}
+
+			template<typename T>
+			static void _put(FILE* pF, const T& v) {
+				_putArray(pF, &v, 1);
+			}
+			template<typename T>
+			static void _putArray(FILE* pF, const T* p, size_t n) {
+				if (n && UNLIKELY(n != fwrite(p, sizeof(T), n, pF))) {
+					T18_ASSERT(!"Failed to write to binFile");
+					throw ::std::runtime_error("Failed to write to binFile");
+				}
+			}
+			//gathers the column get(record) of n records into buf and writes it at once
+			template<typename T, typename F>
+			static void _putColumn(FILE* pF, size_t& pos, ::std::vector<T>& buf, const value_type* pData, size_t n, F&& get) {
+				buf.resize(n);
+				for (size_t i = 0; i < n; ++i) buf[i] = get(pData[i]);
+				_putArray(pF, buf.data(), n);
+				pos += n * sizeof(T);
+			}
+			static void _pad(FILE* pF, size_t& pos, size_t to) {
+				T18_ASSERT(pos <= to);
+				static constexpr char zeros[_i::binFileAlign] = {};
+				if (to > pos && UNLIKELY(1 != fwrite(zeros, to - pos, 1, pF))) {
+					T18_ASSERT(!"Failed to write to binFile");
+					throw ::std::runtime_error("Failed to write to binFile");
+				}
+				pos = to;
+			}
+
+			void _bad(const char* fname, const char* what) {
+				_close();
+				T18_ASSERT(!"Invalid binFile");
+				throw ::std::runtime_error(::std::string("Invalid binFile ") + fname + ": " + what);
+			}
+
+			void _close()noexcept {
+				m_file.close();
+				m_unpacked = ::std::vector<::std::uint8_t>();
+				m_pData = nullptr;
+				m_dataSize = 0;
+				m_bOpened = false;
+			}
+
+			static ::std::vector<::std::uint8_t> _unpack(const char* fname, utils::compression c) {
+				static constexpr size_t chunk = 4 * 1024 * 1024;
+				utils::myFile f(fname, "rb");
+				const auto pDecomp = utils::decompressor::make(c);
+				::std::vector<::std::uint8_t> r;
+				size_t n = 0, got;
+				do {
+					r.resize(n + chunk);
+					got = pDecomp->read(f, reinterpret_cast<char*>(r.data() + n), chunk);
+					n += got;
+				} while (got == chunk);
+				r.resize(n);
+				r.shrink_to_fit();
+				return r;
+			}
+
+		public:
+			binFile() {}
+			binFile(const char* fname) { open(fname); }
+
+			//files compressed with zstd or lz4 (see utils/decompressor.h) are decompressed into memory as a whole
+			void open(const char* fname) {
+				_close();
+				const auto c = utils::compressionOf(fname);
+				if (utils::compression::none == c) {
+					m_file.open(fname);
+					m_pData = m_file.data();
+					m_dataSize = m_file.size();
+				} else {
+					m_unpacked = _unpack(fname, c);
+					m_pData = m_unpacked.data();
+					m_dataSize = m_unpacked.size();
+				}
+				m_bOpened = true;
+
+				if (m_dataSize < sizeof(binFileHeader)) _bad(fname, "too short");
+				::std::memcpy(&m_hdr, m_pData, sizeof(m_hdr));
+
+				if (0 != ::std::memcmp(m_hdr.magic, binFileHeader::magic_v, sizeof(m_hdr.magic))) _bad(fname, "wrong magic");
+				if (binFileHeader::version_v != m_hdr.version) _bad(fname, "unsupported version");
+				if (cols_t::kind != m_hdr.kind) _bad(fname, "wrong kind of records");
+				if (sizeof(real_t) != m_hdr.realSize || sizeof(volume_t) != m_hdr.volumeSize) _bad(fname, "incompatible value types");
+				if (nColumns != m_hdr.nColumns || m_hdr.ticker[binFileHeader::tickerLen - 1]) _bad(fname, "broken header");
+
+				const auto ref = _makeHeader(static_cast<size_t>(m_hdr.count), nullptr, 0);
+				if (0 != ::std::memcmp(ref.colOffs, m_hdr.colOffs, sizeof(ref.colOffs)) || m_dataSize < _fileSize(m_hdr))
+					_bad(fname, "wrong size or layout");
+
+				const auto pD = m_pData;
+				m_pTs = reinterpret_cast<const timestamp_ult*>(pD + m_hdr.colOffs[0]);
+				for (size_t k = 0; k < cols_t::nPrices; ++k) {
+					m_pPrices[k] = reinterpret_cast<const real_t*>(pD + m_hdr.colOffs[k + 1]);
+				}
+				m_pVol = reinterpret_cast<const volume_t*>(pD + m_hdr.colOffs[nColumns - 1]);
+			}
+
+			const binFileHeader& header()const noexcept {
+				T18_ASSERT(m_bOpened);
+				return m_hdr;
+			}
+			bool empty()const noexcept { return 0 == size(); }
+			size_t size()const noexcept { return m_bOpened ? static_cast<size_t>(m_hdr.count) : 0; }
+			size_t capacity()const noexcept { return size(); }
+
+			const char* tickerName()const noexcept { return header().ticker; }
+			unsigned tfMinutes()const noexcept { return header().tfMinutes; }
+			mxTimestamp firstTs()const noexcept { return mxTimestamp(header().firstTs); }
+			mxTimestamp lastTs()const noexcept { return mxTimestamp(header().lastTs); }
+
+			mxTimestamp TS(size_t i)const noexcept {
+				T18_ASSERT(i < size());
+				return mxTimestamp(m_pTs[i]);
+			}
+			value_type operator[](size_t i)const noexcept {
+				T18_ASSERT(i < size());
+				return cols_t::make(m_pTs[i], m_pPrices, m_pVol, i);
+			}
+
+			//returns an index of the first record with timestamp >= ts, or size() if there's no such record
+			size_t lowerBound(mxTimestamp ts)const noexcept {
+				if (empty()) return 0;
+				return static_cast<size_t>(::std::lower_bound(m_pTs, m_pTs + size(), ts._get()) - m_pTs);
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			//replays records [from, to) into srv (see tickerUpdater). If bNotifyEnd is set, the srv.notifyDateTime() is
+			// called afterwards to make sure that all higher-level timeframes are closed
+			template<typename SrvT>
+			void feed(SrvT&& srv, size_t from, size_t to, const bool bNotifyEnd = true)const {
+				T18_ASSERT(from <= to && to <= size());
+				if (from >= to) return;
+
+				for (size_t i = from; i < to; ++i) {
+					const auto e = (*this)[i];
+					if constexpr(bTicks) {
+						srv.newTick(e);
+					} else {
+						srv.newBarOpen(e.TSQ());
+						srv.newBarAggregate(e);
+					}
+				}
+				if (bNotifyEnd) srv.notifyDateTime(TS(to - 1).plusYear());
+			}
+
+			template<typename SrvT>
+			void feed(SrvT&& srv)const {
+				T18_ASSERT(!empty());
+				feed(::std::forward<SrvT>(srv), 0, size());
+			}
+
+			//to be called by backtester
+			template<typename MdssT>
+			::std::enable_if_t<utils::has_tag_t_v<tag_MarketDataStorServ_t, MdssT>> operator()(MdssT& mkt)const {
+				if (mkt.tickersCount() != 1) {
+					T18_ASSERT(!"binFile class supports feeding into only 1 ticker");
+					throw ::std::logic_error("binFile class supports feeding into only 1 ticker");
+				}
+				mkt.forEachTicker([&mkt, ths = this](auto& tickr) {
+					ths->operator()(mkt, tickr);
+				});
+			}
+
+			template<typename MktT, typename TServT>
+			void operator()(MktT& m, TServT& t)const {
+				feed(tickerUpdater<MktT, TServT>(m, t));
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			//writes n records to a new binary file. Records must be sorted by timestamp, that is checked before the file is made
+			static void write(const char* fname, const value_type* pData, const size_t n, const char* ticker, unsigned tfMinutes = 0) {
+				T18_ASSERT(pData || 0 == n);
+				for (size_t i = 1; i < n; ++i) {
+					if (UNLIKELY(pData[i].TS() < pData[i - 1].TS())) {
+						throw ::std::logic_error("binFile::write: record #" + ::std::to_string(i) + " is older than the previous one");
+					}
+				}
+				auto h = _makeHeader(n, ticker, tfMinutes);
+				if (n) {
+					h.firstTs = pData[0].TS()._get();
+					h.lastTs = pData[n - 1].TS()._get();
+				}
+
+				utils::myFile myF(fname, "wb");
+				FILE* pF = myF;
+				_put(pF, h);
+				size_t pos = sizeof(h);
+
+				_pad(pF, pos, static_cast<size_t>(h.colOffs[0]));
+				{
+					::std::vector<timestamp_ult> ts;
+					_putColumn(pF, pos, ts, pData, n, [](const value_type& r)noexcept { return r.TS()._get(); });
+				}
+				{
+					::std::vector<real_t> pr;
+					for (size_t k = 0; k < cols_t::nPrices; ++k) {
+						_pad(pF, pos, static_cast<size_t>(h.colOffs[k + 1]));
+						_putColumn(pF, pos, pr, pData, n, [k](const value_type& r)noexcept { return cols_t::price(r, k); });
+					}
+				}
+				_pad(pF, pos, static_cast<size_t>(h.colOffs[nColumns - 1]));
+				{
+					::std::vector<volume_t> vol;
+					_putColumn(pF, pos, vol, pData, n, [](const value_type& r)noexcept { return r.v; });
+				}
+
+				//the reader relies on the layout the header describes
+				if (UNLIKELY(pos != _fileSize(h))) {
+					T18_ASSERT(!"Written binFile doesn't match its header");
+					throw ::std::logic_error("binFile::write: written data doesn't match the header of " + ::std::string(fname));
+				}
+			}
+			static void write(const char* fname, const ::std::vector<value_type>& d, const char* ticker, unsigned tfMinutes = 0) {
+				write(fname, d.data(), d.size(), ticker, tfMinutes);
+			}
+
+			//the converter: reads the srcFname with the singleFile adapter AdptT and writes the data to the binary file binFname
+			template<typename AdptT>
+			static size_t convert(const char* srcFname, const char* binFname, const char* ticker, unsigned tfMinutes = 0) {
+				static_assert(::std::is_same_v<value_type, typename AdptT::value_t>, "Adapter must produce value_type records");
+				auto d = memory<value_type>::template make<singleFile, AdptT>(hana::make_tuple(srcFname), hana::make_tuple()).release();
+				write(binFname, d, ticker, tfMinutes);
+				return d.size();
+			}
+		};
+
+	}
+}
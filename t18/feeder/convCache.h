@@ -0,0 +1,246 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+// convCache is a persistent cache of timeframe conversions. A source file of ticks or bars is run through a tfConverter
+// once and the resulting bars are stored as a binFile in the cache directory. An entry is keyed by the digest of the source
+// file content, the type of the adapter that reads the source, the type of the converter and its parameters (the
+// timeframe), so neither a changed source nor a different adapter or converter could hit a stale entry.
+// The digest of a source file is stored in the cache directory too and is recomputed only when the size or the
+// modification time of the source file change.
+// Later runs feed the cached bars to a ticker (binFile::feed() or binFile as a backtester feeder) with the usual
+// newBarOpen()/newBarAggregate() sequence, so a derived timeframe is built from a few prepared bars instead of aggregating
+// every source record.
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <functional>
+
+#include "../base.h"
+#include "../base_filesystem.h"
+#include "../utils/myFile.h"
+#include "../utils/name_of_type.h"
+#include "../timeseries/Timeframe.h"
+#include "adapterTraits.h"
+#include "dataCertificate.h"
+#include "binFile.h"
+
+namespace t18 {
+	namespace feeder {
+
+		class convCache {
+		public:
+			static constexpr auto fileExt = ".t18bin";
+			static constexpr auto digestExt = ".t18digest";
+
+		protected:
+			//content of a digest file
+			struct digestRec {
+				::std::uint64_t fileSize;
+				::std::int64_t mtime;
+				::std::uint64_t digest;
+			};
+
+		protected:
+			::std::string m_dir;
+
+		protected:
+			//64 bit FNV-1a, the same hash as dataCertificate::checksumOf() uses
+			static ::std::uint64_t _hash(const void* p, size_t n, ::std::uint64_t h = 14695981039346656037ull)noexcept {
+				const auto pB = static_cast<const unsigned char*>(p);
+				for (size_t i = 0; i < n; ++i) {
+					h = (h ^ pB[i]) * 1099511628211ull;
+				}
+				return h;
+			}
+
+			static ::std::string _hex(::std::uint64_t v) {
+				char buf[17];
+				snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+				return buf;
+			}
+
+			//unique name of a temporary file for fn, so concurrent writers (threads or processes) never share one
+			static ::std::string _tmpNameFor(const ::std::string& fn) {
+				static ::std::atomic<::std::uint64_t> s_cnt{ 0 };
+				::std::random_device rd;
+				const ::std::uint64_t v[3] = { (static_cast<::std::uint64_t>(rd()) << 32) ^ rd()
+					, s_cnt.fetch_add(1, ::std::memory_order_relaxed)
+					, static_cast<::std::uint64_t>(::std::hash<::std::thread::id>()(::std::this_thread::get_id())) };
+				return fn + "." + _hex(_hash(v, sizeof(v))) + ".tmp";
+			}
+
+			//writes a file with writeF(tmpName) to a temporary file first and then renames it to fn, so an interrupted run
+			// never leaves a broken file. Returns false if fn couldn't be replaced
+			template<typename WriteF>
+			static bool _writeAtomically(const ::std::string& fn, WriteF&& writeF) {
+				const auto tmp = _tmpNameFor(fn);
+				try {
+					writeF(tmp.c_str());
+				} catch (...) {
+					::std::remove(tmp.c_str());
+					throw;
+				}
+				::std::error_code ec;
+				T18_FILESYSTEM_NAMESPACE::rename(T18_FILESYSTEM_NAMESPACE::path(tmp), T18_FILESYSTEM_NAMESPACE::path(fn), ec);
+				if (ec) {
+					::std::remove(tmp.c_str());
+					return false;
+				}
+				return true;
+			}
+
+			//digest of the content of srcFname, that is read from the digest file if the source is unchanged
+			::std::uint64_t _digestOf(const char* srcFname)const {
+				digestRec r;
+				utils::myFile::stamp(srcFname, r.fileSize, r.mtime);
+
+				const T18_FILESYSTEM_NAMESPACE::path src(srcFname);
+				const auto absName = T18_FILESYSTEM_NAMESPACE::absolute(src).string();
+				const ::std::string dfn(m_dir + src.stem().string() + "-" + _hex(_hash(absName.data(), absName.size())) + digestExt);
+				if (utils::myFile::exist(dfn.c_str())) {
+					utils::myFile f(dfn.c_str(), "rb");
+					digestRec c;
+					if (1 == fread(&c, sizeof(c), 1, f) && c.fileSize == r.fileSize && c.mtime == r.mtime) return c.digest;
+				}
+
+				r.digest = dataCertificate::checksumOf(srcFname);
+				//the digest file is just an optimization, so failing to write it isn't an error
+				try {
+					_writeAtomically(dfn, [&r](const char* fn) {
+						utils::myFile f(fn, "wb");
+						if (1 != fwrite(&r, sizeof(r), 1, f)) throw ::std::runtime_error("convCache: failed to write the digest");
+					});
+				} catch (const ::std::exception&) {}
+				return r.digest;
+			}
+
+		public:
+			//the directory is created if it doesn't exist
+			explicit convCache(::std::string dir) : m_dir(::std::move(dir)) {
+				if (!m_dir.empty()) {
+					T18_FILESYSTEM_NAMESPACE::create_directories(T18_FILESYSTEM_NAMESPACE::path(m_dir));
+					if ('/' != m_dir.back() && '\\' != m_dir.back()) m_dir += '/';
+				}
+			}
+
+			const ::std::string& dir()const noexcept { return m_dir; }
+
+			//returns the name of the cache entry for the conversion of srcFname read by the adapter AdptT by the conv. The
+			// source file is read as a whole to make the digest only if it's new or has changed since the last call
+			template<typename AdptT, typename TfConvT>
+			::std::string entryFor(const char* srcFname, const TfConvT& conv)const {
+				const ::std::uint64_t digest = _digestOf(srcFname);
+				const auto& adptName = utils::name_of_type<::std::decay_t<AdptT>>();
+				const auto& convName = utils::name_of_type<TfConvT>();
+				const int tf = conv.tf();
+
+				auto k = _hash(&digest, sizeof(digest));
+				k = _hash(adptName.data(), adptName.size(), k);
+				k = _hash(convName.data(), convName.size(), k);
+				k = _hash(&tf, sizeof(tf), k);
+				return m_dir + T18_FILESYSTEM_NAMESPACE::path(srcFname).stem().string() + "-M" + ::std::to_string(tf)
+					+ "-" + _hex(k) + fileExt;
+			}
+
+			//runs the converter over every record of srcFname read by the adapter AdptT and returns the bars made. The last
+			// bar is closed as if the data stream ended
+			template<typename AdptT, typename TfConvT>
+			static ::std::vector<typename TfConvT::bar_t> convert(const char* srcFname, TfConvT conv, AdptT adpt = AdptT()) {
+				typedef typename AdptT::value_t value_t;
+				typedef typename TfConvT::bar_t bar_t;
+
+				::std::vector<bar_t> r;
+				timeseries::Timeframe<TfConvT> tf(size_t(2), ::std::move(conv));
+				auto h = tf.registerOnNewBarClose([&r](const bar_t& b) { r.push_back(b); });
+
+				adapterFile_t<AdptT> f(srcFname, "r");
+				value_t v;
+				int nRead;
+				size_t n = 0;
+				mxTimestamp lastTs;
+				while (adpt.readNext(f, v, nRead)) {
+					++n;
+					if constexpr(::std::is_base_of_v<tsTick, value_t>) {
+						tf._newTick_pre(v.TS());
+						tf._newTick(v);
+						tf._newTick_post();
+					} else {
+						tf._newBarOpen_pre(v.TS());
+						tf._newBarOpen(v.TSQ());
+						tf._newBarOpen_post();
+						tf._newBarAggregate(v);
+					}
+					lastTs = v.TS();
+				}
+				if (UNLIKELY(!feof(f) || EOF != nRead)) {
+					T18_ASSERT(!"Failed to parse the source file");
+					throw ::std::runtime_error("convCache: failed to parse record #"s + ::std::to_string(n + 1) + " of " + srcFname);
+				}
+
+				if (n) {
+					const auto ts = lastTs.plusYear();
+					tf._notifyDateTime(ts);
+					tf._notifyDateTime_post(ts);
+				}
+				return r;
+			}
+
+			//returns the name of a binFile with bars of srcFname converted by the conv. The conversion is done and stored only
+			// if there's no such entry in the cache yet. *pbHit is set to true when the cached entry was used
+			template<typename AdptT, typename TfConvT>
+			::std::string get(const char* srcFname, TfConvT conv, bool* pbHit = nullptr, AdptT adpt = AdptT())const {
+				typedef typename TfConvT::bar_t bar_t;
+
+				auto fn = entryFor<AdptT>(srcFname, conv);
+				const bool bHit = utils::myFile::exist(fn.c_str());
+				if (pbHit) *pbHit = bHit;
+				if (!bHit) {
+					const auto tfMinutes = static_cast<unsigned>(conv.tf());
+					const auto bars = convert(srcFname, ::std::move(conv), ::std::move(adpt));
+
+					const auto ticker = T18_FILESYSTEM_NAMESPACE::path(srcFname).stem().string();
+					const bool bStored = _writeAtomically(fn, [&bars, &ticker, tfMinutes](const char* tmp) {
+						binFile<bar_t>::write(tmp, bars, ticker.c_str(), tfMinutes);
+					});
+					if (!bStored) {
+						//the entry might have been made by a concurrent run
+						if (UNLIKELY(!utils::myFile::exist(fn.c_str()))) {
+							T18_ASSERT(!"Failed to store the cache entry");
+							throw ::std::runtime_error("convCache: failed to store " + fn);
+						}
+					}
+				}
+				return fn;
+			}
+
+			//removes the entry made for the conversion of srcFname read by the adapter AdptT by the conv. Returns true if it
+			// existed
+			template<typename AdptT, typename TfConvT>
+			bool invalidate(const char* srcFname, const TfConvT& conv)const {
+				return 0 == ::std::remove(entryFor<AdptT>(srcFname, conv).c_str());
+			}
+		};
+
+	}
+}
@@ -0,0 +1,186 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+// dataCertificate is a sidecar file (<data file>.t18cert) stating that a data file has passed a full validation: every
+// record is valid and timestamps are ordered the way timeframes require. Feeders could then switch tickers to the trusted
+// mode (see tickerServer::trustData()) that skips per record checks, if the certificate matches the file and the file
+// is fed as the same type of records it was validated as.
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+
+#include "../base.h"
+#include "../utils/myFile.h"
+#include "adapterTraits.h"
+
+namespace t18 {
+	namespace feeder {
+
+		class dataCertificate {
+		public:
+			static constexpr auto sidecarExt = ".t18cert";
+
+		protected:
+			struct header {
+				char magic[8];
+				::std::uint64_t version;
+				//see kindOf()
+				::std::uint64_t valueKind;
+				::std::uint64_t fileSize;
+				::std::int64_t mtime;
+				::std::uint64_t checksum;
+				::std::uint64_t count;
+				timestamp_ult firstTs;
+				timestamp_ult lastTs;
+			};
+			static constexpr char magic_v[8] = { 't','1','8','c','e','r','t','\0' };
+			static constexpr ::std::uint64_t version_v = 2;
+
+		protected:
+			header m_hdr;
+
+		protected:
+			static bool _fail(::std::string* pErr, const char* fname, size_t n, const char* what) {
+				if (pErr) *pErr = "record #"s + ::std::to_string(n) + " of " + fname + ": " + what;
+				return false;
+			}
+
+			bool _load(const char* fname) {
+				const ::std::string sc(::std::string(fname) + sidecarExt);
+				if (!utils::myFile::exist(sc.c_str())) return false;
+				utils::myFile f(sc.c_str(), "rb");
+				header h;
+				if (1 != fread(&h, sizeof(h), 1, f) || 0 != ::std::memcmp(h.magic, magic_v, sizeof(magic_v))
+					|| version_v != h.version)
+				{
+					return false;
+				}
+				m_hdr = h;
+				return true;
+			}
+
+		public:
+			dataCertificate()noexcept {
+				::std::memset(&m_hdr, 0, sizeof(m_hdr));
+			}
+
+			size_t count()const noexcept { return static_cast<size_t>(m_hdr.count); }
+			mxTimestamp firstTs()const noexcept { return mxTimestamp(m_hdr.firstTs); }
+			mxTimestamp lastTs()const noexcept { return mxTimestamp(m_hdr.lastTs); }
+			::std::uint64_t checksum()const noexcept { return m_hdr.checksum; }
+			::std::uint64_t valueKind()const noexcept { return m_hdr.valueKind; }
+
+			//identifies the type of records a file is validated as. Validity depends on it: for example, ticks could share
+			// the same timestamp while bars of a timeframe must not, so a file certified as ticks isn't valid as bars.
+			template<typename ValueT>
+			static constexpr ::std::uint64_t kindOf()noexcept {
+				typedef ::std::decay_t<ValueT> v_t;
+				constexpr ::std::uint64_t id = ::std::is_same_v<v_t, tsohlcv> ? 1 : ::std::is_same_v<v_t, tsDeal> ? 2
+					: ::std::is_same_v<v_t, tsTick> ? 3 : ::std::is_same_v<v_t, tsq_data> ? 4 : 0;
+				return (id << 32) | (static_cast<::std::uint64_t>(sizeof(v_t)) << 1) | (::std::is_base_of_v<tsTick, v_t> ? 1 : 0);
+			}
+
+			//64 bit FNV-1a hash of the file content
+			static ::std::uint64_t checksumOf(const char* fname) {
+				static constexpr size_t blockSize = 1024 * 1024;
+				utils::myFile f(fname, "rb");
+				::std::unique_ptr<unsigned char[]> buf(new unsigned char[blockSize]);
+				::std::uint64_t h = 14695981039346656037ull;
+				size_t n;
+				while ((n = fread(buf.get(), 1, blockSize, f)) > 0) {
+					for (size_t i = 0; i < n; ++i) {
+						h = (h ^ buf[i]) * 1099511628211ull;
+					}
+				}
+				if (UNLIKELY(ferror(f))) {
+					T18_ASSERT(!"Failed to read the file");
+					throw ::std::runtime_error("dataCertificate: failed to read "s + fname);
+				}
+				return h;
+			}
+
+			//validates every record of the file read by the adapter AdptT and saves the certificate if the data is valid.
+			//Returns false (and the description of the first problem in *pErr) if the data is invalid.
+			template<typename AdptT>
+			static bool issue(const char* fname, ::std::string* pErr = nullptr, AdptT adpt = AdptT()) {
+				typedef typename AdptT::value_t value_t;
+				//bars of a timeframe must have strictly increasing timestamps, while ticks could share the same timestamp
+				static constexpr bool bTicks = ::std::is_base_of_v<tsTick, value_t>;
+
+				dataCertificate r;
+				::std::memcpy(r.m_hdr.magic, magic_v, sizeof(magic_v));
+				r.m_hdr.version = version_v;
+				r.m_hdr.valueKind = kindOf<value_t>();
+				utils::myFile::stamp(fname, r.m_hdr.fileSize, r.m_hdr.mtime);
+
+				{
+					adapterFile_t<AdptT> f(fname, "r");
+					value_t v;
+					int nRead;
+					size_t n = 0;
+					mxTimestamp prev;
+					while (true) {
+						if (!adpt.readNext(f, v, nRead)) {
+							if (!feof(f) || EOF != nRead) return _fail(pErr, fname, n + 1, "failed to parse");
+							break;
+						}
+						++n;
+						if (v.invalid()) return _fail(pErr, fname, n, "invalid data");
+						if (n > 1 && (bTicks ? v.TS() < prev : v.TS() <= prev)) return _fail(pErr, fname, n, "unordered timestamp");
+						if (1 == n) r.m_hdr.firstTs = v.TS()._get();
+						prev = v.TS();
+					}
+					r.m_hdr.count = n;
+					r.m_hdr.lastTs = prev._get();
+				}
+
+				r.m_hdr.checksum = checksumOf(fname);
+				r.save(fname);
+				return true;
+			}
+
+			void save(const char* fname)const {
+				const ::std::string sc(::std::string(fname) + sidecarExt);
+				utils::myFile f(sc.c_str(), "wb");
+				if (1 != fwrite(&m_hdr, sizeof(m_hdr), 1, f)) {
+					T18_ASSERT(!"Failed to write the certificate");
+					throw ::std::runtime_error("Failed to write the certificate " + sc);
+				}
+			}
+
+			//checks that the file has a certificate that matches the file and that it was issued for records of the
+			// adapter AdptT. By default only the file size and the modification time are compared, bFullCheck makes it to
+			// verify the checksum of the content too
+			template<typename AdptT>
+			static bool isValidFor(const char* fname, bool bFullCheck = false) {
+				dataCertificate c;
+				if (!c._load(fname) || kindOf<typename ::std::decay_t<AdptT>::value_t>() != c.m_hdr.valueKind) return false;
+
+				::std::uint64_t fileSize;
+				::std::int64_t mtime;
+				utils::myFile::stamp(fname, fileSize, mtime);
+				if (fileSize != c.m_hdr.fileSize || mtime != c.m_hdr.mtime) return false;
+				return !bFullCheck || checksumOf(fname) == c.m_hdr.checksum;
+			}
+		};
+
+	}
+}
@@ -0,0 +1,184 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+// bounded pool of open files for feeder::multiFile. Files are opened lazily and only a limited number of the most
+// recently used of them is kept open; the rest are closed remembering the position to continue reading from. Records
+// are parsed into per-ticker read-ahead buffers by large batches, so reopening a file is rare.
+
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "../base.h"
+#include "parsingPool.h"
+
+namespace t18 {
+	namespace feeder {
+		namespace _i {
+
+			class filePool;
+
+			class pooledFileBase {
+				friend class filePool;
+
+			protected:
+				::std::list<pooledFileBase*>::iterator m_lruIt;
+				bool m_bPooled = false;
+
+			protected:
+				//must remember the position and close the file
+				virtual void _suspend() = 0;
+
+			public:
+				virtual ~pooledFileBase() {}
+			};
+
+			//keeps at most maxOpen files opened, closing the least recently used ones
+			class filePool {
+			protected:
+				//the most recently used file is at the front
+				::std::list<pooledFileBase*> m_lru;
+				size_t m_maxOpen;
+
+			public:
+				explicit filePool(size_t maxOpen)noexcept : m_maxOpen(maxOpen) {
+					T18_ASSERT(maxOpen > 0);
+				}
+				filePool(const filePool&) = delete;
+				filePool& operator=(const filePool&) = delete;
+
+				size_t maxOpen()const noexcept { return m_maxOpen; }
+				size_t openedCount()const noexcept { return m_lru.size(); }
+
+				//to be called before reading the opened file f. If f isn't yet in the pool, other files may be closed to
+				// make room for it.
+				void touch(pooledFileBase& f) {
+					if (f.m_bPooled) {
+						m_lru.splice(m_lru.begin(), m_lru, f.m_lruIt);
+					} else {
+						while (m_lru.size() >= m_maxOpen) {
+							auto pLast = m_lru.back();
+							m_lru.pop_back();
+							pLast->m_bPooled = false;
+							pLast->_suspend();
+						}
+						m_lru.push_front(&f);
+						f.m_lruIt = m_lru.begin();
+						f.m_bPooled = true;
+					}
+				}
+
+				//to be called when f is closed for good
+				void forget(pooledFileBase& f)noexcept {
+					if (f.m_bPooled) {
+						m_lru.erase(f.m_lruIt);
+						f.m_bPooled = false;
+					}
+				}
+			};
+
+			//reads records of a ticker file in batches of readAhead records, reopening the file when necessary.
+			//The file object exists only while the file is open, so memory usage is bounded by the pool limit
+			template<typename AdptT, typename FileT>
+			class pooledReader : public pooledFileBase, public recordSource<typename AdptT::value_t> {
+			public:
+				typedef typename AdptT::value_t bar_t;
+
+			protected:
+				filePool& m_pool;
+				AdptT& m_adpt;
+				const ::std::string m_fname;
+				const ::std::string m_tickerName;
+
+				::std::unique_ptr<FileT> m_pF;
+				::std::uint64_t m_ofs = 0;
+				size_t m_nLinesRead = 0;
+				bool m_bEnd = false;
+
+				::std::vector<bar_t> m_buf;
+				size_t m_pos = 0;
+				const size_t m_readAhead;
+
+			protected:
+				virtual void _suspend() override {
+					T18_ASSERT(m_pF);
+					m_ofs = m_pF->tell();
+					m_pF.reset();
+				}
+
+				bool _refill() {
+					//making room before opening the file, so there're never more than maxOpen files opened
+					m_pool.touch(*this);
+					if (!m_pF) {
+						try {
+							m_pF = ::std::make_unique<FileT>();
+							if (!m_pF->open(m_fname.c_str(), "r")) {
+								T18_ASSERT(!"Failed to open csv file");
+								throw ::std::runtime_error("Failed to open csv file, path="s + m_fname);
+							}
+							if (m_ofs) m_pF->seek(m_ofs);
+						} catch (...) {
+							m_pool.forget(*this);
+							m_pF.reset();
+							throw;
+						}
+					}
+
+					m_buf.clear();
+					m_pos = 0;
+					int nRead;
+					bar_t v;
+					while (m_buf.size() < m_readAhead) {
+						++m_nLinesRead;
+						if (!m_adpt.readNext(*m_pF, v, nRead)) {
+							const bool isEOF = feof(*m_pF);
+							m_pool.forget(*this);
+							m_pF.reset();
+							m_bEnd = true;
+							checkEndOfRecords(isEOF, nRead, m_tickerName, m_nLinesRead);
+							break;
+						}
+						m_buf.push_back(v);
+					}
+					return !m_buf.empty();
+				}
+
+			public:
+				pooledReader(filePool& pool, AdptT& adpt, ::std::string&& fname, const ::std::string& tickerName, size_t readAhead)
+					: m_pool(pool), m_adpt(adpt), m_fname(::std::move(fname)), m_tickerName(tickerName), m_readAhead(readAhead)
+				{
+					T18_ASSERT(readAhead > 0);
+					m_buf.reserve(readAhead);
+				}
+
+				~pooledReader() {
+					m_pool.forget(*this);
+				}
+
+				virtual bool pop(bar_t& v) override {
+					if (m_pos >= m_buf.size() && (m_bEnd || !_refill())) return false;
+					v = m_buf[m_pos++];
+					return true;
+				}
+			};
+
+		}
+	}
+}
@@ -115,10 +115,13 @@ namespace t18 {
 
 				f.processByAdapter();
 
-				T18_ASSERT(sz == m_data.size() || sz - 1 == m_data.size());
+				//capacity is an upper bound when the feeder reads a range of a file
+				T18_ASSERT(m_data.size() <= sz);
 			}
 
 			void clear(){ m_data.clear(); }
+			//moves out the data leaving the object empty
+			::std::vector<value_type> release()noexcept { return ::std::move(m_data); }
 			bool empty()const { return m_data.empty(); }
 
 			template<typename SrvT>
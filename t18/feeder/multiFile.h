@@ -20,17 +20,24 @@
 // this is a bit proper implementation of feeder concept, that represents more proper way to extract tsohlcv data
 // from a (csv-files based) library
 
+#include <vector>
+#include <algorithm>
+#include <memory>
+
 #include "../base.h"
 #include "../utils/myFile.h"
 //#include "../market/MarketDataStorServ.h"
 #include "../market/tickerBase.h"
 #include "adapters/csv.h"
+#include "singleFile.h"
+#include "parsingPool.h"
+#include "filePool.h"
 
 namespace t18 {
 	namespace feeder {
 
 		//to minimize memory usage this class read files and passes the data to backtester live
-		//#TODO However for the optimization or any mass testing purposes the data should be cached at memory first.
+		//For the optimization or any mass testing purposes use sharedTimeline, that caches the merged data in memory.
 		//template parameter Ticker2AdapterHMT is a type of hana::map that maps ticker type (or void as default)
 		// to specific feeder::adapter that is used to populate that ticker.
 		template<typename Ticker2AdapterHMT = utils::makeMap_t<decltype(hana::make_pair(hana::type_c<void>, hana::type_c<adapters::csv_tsohlcv>))>>
@@ -63,9 +70,26 @@ namespace t18 {
 			typedef Ticker2AdapterHMT ticker2adapter_descr_hmt;
 			typedef decltype(_makeTicker2AdapterMap(ticker2adapter_descr_hmt())) ticker2adapter_hmt;
 
+			static constexpr size_t defaultParsingQueueSize = 4096;
+			static constexpr size_t defaultReadAheadRecords = 4096;
+
 		protected:
 			const char* m_libPath = nullptr;
 			ticker2adapter_hmt m_adapterMap;
+			//extension of ticker files
+			::std::string m_fileExt{ ".csv" };
+
+			//number of worker threads that parse files ahead of the merge stage. 0 means files are parsed by the
+			// thread that calls operator()
+			size_t m_nParsingThreads = 0;
+			size_t m_parsingQueueSize = defaultParsingQueueSize;
+
+			//max number of simultaneously opened files. 0 means every file is opened for the whole run
+			size_t m_maxOpenFiles = 0;
+			size_t m_readAheadRecords = defaultReadAheadRecords;
+
+			//see trustCertifiedData()
+			bool m_bTrustCertified = false;
 
 		protected:
 			template<typename T>
@@ -89,6 +113,42 @@ namespace t18 {
 				m_libPath = pLib;
 			}
 
+			//sets the extension of ticker files (".csv" by default), so the files are <libPath>/<ticker><ext>. For example,
+			// ".csv.zst" makes the fast csv adapters to read zstd compressed files (see utils/decompressor.h)
+			void setFilesExtension(const char* ext) {
+				T18_ASSERT(ext);
+				m_fileExt = ext;
+			}
+
+			//enables pipelined parsing: files are parsed by nThreads worker threads (each one serves its share of files)
+			// into bounded lock-free queues of queueSize records per file, so the feeding thread only merges already parsed
+			// records. Makes sense when parsing (not the strategy) dominates the backtest time and there're several tickers.
+			// The adapters must allow concurrent readNext() calls for different files. Feeding order is exactly the same
+			// as in the default single threaded mode.
+			void setParsingThreads(size_t nThreads, size_t queueSize = defaultParsingQueueSize)noexcept {
+				T18_ASSERT(queueSize > 0);
+				m_nParsingThreads = nThreads;
+				m_parsingQueueSize = queueSize;
+			}
+			size_t parsingThreads()const noexcept { return m_nParsingThreads; }
+
+			//limits the number of simultaneously opened files to maxOpen, so universes of any size could be fed without
+			// hitting the OS limit of open files. Files are opened lazily, only maxOpen most recently used files are kept
+			// opened and records are parsed into per-ticker buffers by batches of readAhead records. So memory usage is
+			// about maxOpen file buffers plus readAhead records per ticker. Can't be used together with setParsingThreads()
+			//Note that a compressed file is decompressed from the beginning every time it's reopened (see
+			// utils::blockFile::seek()), so for compressed libraries keep readAhead large.
+			void setOpenFilesLimit(size_t maxOpen, size_t readAhead = defaultReadAheadRecords)noexcept {
+				T18_ASSERT(readAhead > 0);
+				m_maxOpenFiles = maxOpen;
+				m_readAheadRecords = readAhead;
+			}
+			size_t openFilesLimit()const noexcept { return m_maxOpenFiles; }
+
+			//if set, a ticker is switched to the trusted mode (see tickerServer::trustData()) when its data file has a
+			// matching dataCertificate
+			void trustCertifiedData(bool b = true)noexcept { m_bTrustCertified = b; }
+
 			//////////////////////////////////////////////////////////////////////////
 		protected:
 
@@ -98,74 +158,102 @@ namespace t18 {
 			//first timeframe and it may differ from the data read from file (timeframe could be operating on tsohlcv, while file
 			// could contain simple tsTick-s)
 			// tickerCtx exists for every ticker
-			template<typename BarT>
+			template<typename BarT, typename FileT = utils::myFile>
 			struct tickerCtx {
 				typedef BarT bar_t;
 
-				utils::myFile hF;
+				FileT hF;
 
 				bar_t bar = bar_t(invalidTs);
 				size_t nLinesRead = 0;
 
+				//set only in the pipelined parsing mode (hF is owned by a worker thread then) or when the number of open
+				// files is limited (hF isn't used then)
+				::std::unique_ptr<_i::recordSource<bar_t>> pSource;
+
 				//TickerId tiid;
 
 				//tickerCtx()noexcept : tiid(TickerId::forEveryone()) {}
 			};
 
-			//the data type to help synchronize time flow of different files
-			struct readingCtx {
-				mxTimestamp earliestTs;
-				TickerId tiidOfEarliestTs;
+			//min-heap of the next records of every ticker, that is used to merge time flows of different files. Each emitted
+			// record costs O(log N). Records with equal timestamps are emitted in the order of tickers initialization
+			// (i.e. in the order of MdssT::forEachTickerIndexed())
+			struct mergeHeap {
+				struct entry {
+					mxTimestamp ts;
+					size_t order;
+					TickerId tiid;
+
+					//"greater", as std heap functions make a max-heap
+					bool operator<(const entry& r)const noexcept {
+						return ts > r.ts || (ts == r.ts && order > r.order);
+					}
+				};
+
+				::std::vector<entry> m_heap;
 
-				readingCtx()noexcept : earliestTs(invalidTs), tiidOfEarliestTs(TickerId::forEveryone()) {}
-				void reset()noexcept {
-					earliestTs = invalidTs;
-					//tiidOfEarliestDt = invalidTiid;
+				bool empty()const noexcept { return m_heap.empty(); }
+				const entry& top()const noexcept {
+					T18_ASSERT(!empty());
+					return m_heap.front();
 				}
-				constexpr bool isValid()const noexcept {
-					//T18_ASSERT(!( (earliestDt == invalidDt) ^ (tiidOfEarliestDt==invalidTiid)));
-					return earliestTs != invalidTs;
+				void push(const entry& e) {
+					m_heap.push_back(e);
+					::std::push_heap(m_heap.begin(), m_heap.end());
+				}
+				entry pop()noexcept {
+					T18_ASSERT(!empty());
+					::std::pop_heap(m_heap.begin(), m_heap.end());
+					const auto r = m_heap.back();
+					m_heap.pop_back();
+					return r;
 				}
 			};
 
+			//returns true if a new bar has been read into ctx.bar, or false on the end of file
 			template<typename AdptT>
-			static void sReadBar(AdptT&& adpt, tickerCtx<typename ::std::decay_t<AdptT>::value_t>& ctx, readingCtx& rctx, tickerBase& Tickr) {
-				T18_ASSERT(ctx.hF.isOpened());// && Tickr.getTickerId() == ctx.tiid);
-				
-				int nRead;
-
+			static bool sReadBar(AdptT&& adpt, tickerCtx<typename ::std::decay_t<AdptT>::value_t, adapterFile_t<AdptT>>& ctx
+				, tickerBase& Tickr)
+			{
+				bool bRead;
 				++ctx.nLinesRead;
-				if (adpt.readNext(ctx.hF, ctx.bar, nRead)) {
+				if (ctx.pSource) {
+					bRead = ctx.pSource->pop(ctx.bar);
+				} else {
+					T18_ASSERT(ctx.hF.isOpened());// && Tickr.getTickerId() == ctx.tiid);
+					int nRead;
+					bRead = adpt.readNext(ctx.hF, ctx.bar, nRead);
+					if (!bRead) {
+						bool isEOF = feof(ctx.hF);
+						ctx.hF.close();
+						_i::checkEndOfRecords(isEOF, nRead, Tickr.Name(), ctx.nLinesRead);
+					}
+				}
+				if (bRead) {
 					//setting the bid/ask spread to bar opening data (we can't make a better guess here) in advance
 					//this would make more realistic trade entry points should we trade using different tickers
 					adpt._setBestGuessBidAsk(Tickr, ctx.bar.TSQ());
-
-					if (ctx.bar.TS() < rctx.earliestTs) {
-						rctx.earliestTs = ctx.bar.TS();
-						rctx.tiidOfEarliestTs = Tickr.getTickerId();
-					}
-				} else {
-					bool isEOF = feof(ctx.hF);
-					ctx.hF.close();
-					if (LIKELY(isEOF)) {
-						if (UNLIKELY(EOF != nRead)) {
-							T18_ASSERT(!"Invalid end of file!");
-							throw ::std::runtime_error("Invalid end of csv for ticker "s + Tickr.Name()
-								+ " at line#" + ::std::to_string(ctx.nLinesRead) + " read "
-								+ ::std::to_string(nRead) + " !=0 elements");
-						}
-					} else {
-						T18_ASSERT(!"Failed to read csv line");
-						throw ::std::runtime_error("Failed to read csv for ticker "s + Tickr.Name()
-							+ " line #"s + ::std::to_string(ctx.nLinesRead) + ". Read only "
-							+ ::std::to_string(nRead) + "!=tsohlcv::numOfCsvElements elements");
-					}
 				}
+				return bRead;
 			}
 
+			//settings of a particular feeding run
+			struct runSetup {
+				::std::string libPath;
+				::std::string fileExt;
+				//0 if pipelined parsing is off
+				size_t parsingQueueSize;
+				::std::vector<_i::parsedStreamBase*> streams;
+				//nullptr if the number of open files isn't limited
+				_i::filePool* pFilePool;
+				size_t readAheadRecords;
+				bool bTrustCertified;
+			};
+
 		private:
-			template<typename BarT>
-			using singleTickerTypeCtx_tpl = ::std::vector<tickerCtx<BarT>>;
+			template<typename BarT, typename FileT = utils::myFile>
+			using singleTickerTypeCtx_tpl = ::std::vector<tickerCtx<BarT, FileT>>;
 
 			template<typename HTT, typename = ::std::enable_if_t<utils::isDescrTuple_v<HTT>>>
 			static constexpr auto makeCtxStor(HTT const& tup) {
@@ -179,13 +267,16 @@ namespace t18 {
 						)> adpt_t;
 
 					//return ::std::declval<singleTickerTypeCtx_tpl<typename ticker_t::bar_t>>();
-					return ::std::declval<singleTickerTypeCtx_tpl<typename adpt_t::value_t>>();
+					return ::std::declval<singleTickerTypeCtx_tpl<typename adpt_t::value_t, adapterFile_t<adpt_t>>>();
 				});
 			}
 			
+			//opens the file of a ticker (or just checks it exists, if the number of open files is limited). If the parsing
+			// queue size is non-zero, also sets up the pipelined parsing of the file.
+			//Returns true if the data of the ticker could be trusted
 			template<typename AdptT> //, typename TickerBaseT, typename = ::std::enable_if_t<utils::is_tag_of_v<tag_Ticker_t, TickerBaseT>>>
-			static void _sInitCtxs(AdptT&& adpt, singleTickerTypeCtx_tpl<typename ::std::decay_t<AdptT>::value_t>& vCtx
-				, readingCtx& rctx, const ::std::string& libPath, tickerBase& tickr)
+			static bool _sInitCtxs(AdptT&& adpt, singleTickerTypeCtx_tpl<typename ::std::decay_t<AdptT>::value_t, adapterFile_t<AdptT>>& vCtx
+				, runSetup& setup, tickerBase& tickr)
 			{
 				auto tickerIdx = tickr.getTickerId().getIdx();
 				T18_ASSERT(tickerIdx < vCtx.size());
@@ -193,35 +284,68 @@ namespace t18 {
 				auto& ctx = vCtx[tickerIdx];
 				//ctx.tiid = tickr.getTickerId();
 
-				const ::std::string fname(libPath + tickr.Name() + ".csv");
+				::std::string fname(setup.libPath + tickr.Name() + setup.fileExt);
+				const bool bTrusted = setup.bTrustCertified && dataCertificate::isValidFor<AdptT>(fname.c_str());
+				if (setup.pFilePool) {
+					if (!utils::myFile::exist(fname.c_str())) {
+						T18_ASSERT(!"Failed to open csv file");
+						throw ::std::runtime_error("Failed to open csv file, path="s + fname);
+					}
+					typedef _i::pooledReader<::std::remove_reference_t<AdptT>, adapterFile_t<AdptT>> reader_t;
+					ctx.pSource = ::std::make_unique<reader_t>(*setup.pFilePool, adpt, ::std::move(fname), tickr.Name()
+						, setup.readAheadRecords);
+					return bTrusted;
+				}
+
 				if (!ctx.hF.open(fname.c_str(), "r")) {
 					T18_ASSERT(!"Failed to open csv file");
 					throw ::std::runtime_error("Failed to open csv file, path="s + fname);
 				}
 
-				sReadBar(adpt, ctx, rctx, tickr);
-				if (UNLIKELY(ctx.bar.TS() == invalidTs)) {
-					T18_ASSERT(!"Failed to read a first bar from csv file");
-					throw ::std::runtime_error("Failed to read first bar, path="s + fname);
+				if (setup.parsingQueueSize) {
+					typedef _i::parsedStream<::std::remove_reference_t<AdptT>, adapterFile_t<AdptT>> stream_t;
+					auto pS = ::std::make_unique<stream_t>(adpt, ctx.hF, tickr.Name(), setup.parsingQueueSize);
+					setup.streams.push_back(pS.get());
+					ctx.pSource = ::std::move(pS);
 				}
+				return bTrusted;
 			}
 
-			template<typename BarT>
-			static void _sUpdateCtxs(singleTickerTypeCtx_tpl<BarT>& vCtx, readingCtx& rctx, const tickerBase& tickr) {
-				const auto tiid = tickr.getTickerId();
-				const auto& ctxBarDt = vCtx[tiid.getIdx()].bar.TS();
-				if (ctxBarDt < rctx.earliestTs) {
-					rctx.earliestTs = ctxBarDt;
-					rctx.tiidOfEarliestTs = tiid;
+			template<typename AdptT>
+			static void _sReadFirstBar(AdptT&& adpt, singleTickerTypeCtx_tpl<typename ::std::decay_t<AdptT>::value_t, adapterFile_t<AdptT>>& vCtx
+				, mergeHeap& heap, tickerBase& tickr)
+			{
+				auto& ctx = vCtx[tickr.getTickerId().getIdx()];
+				if (UNLIKELY(!sReadBar(adpt, ctx, tickr))) {
+					T18_ASSERT(!"Failed to read a first bar from csv file");
+					throw ::std::runtime_error("Failed to read first bar of ticker "s + tickr.Name());
 				}
+				heap.push({ ctx.bar.TS(), heap.m_heap.size(), tickr.getTickerId() });
 			}
 
 		public:
 			//called by the backtester to start data feeding process
 			template<typename MdssT, typename = ::std::enable_if_t<utils::is_tag_of_v<tag_MarketDataStorServ_t, MdssT>>>
 			void operator()(MdssT& m) {
+				(*this)(m, [](mxTimestamp)noexcept {});
+			}
+
+			//the same, but onGroupEnd(mxTimestamp ts) is called after all records with the timestamp ts have been passed to
+			// the market, i.e. when the next record has a greater timestamp or there's no more data. This allows to process
+			// updates of different tickers that happened at the same time as a block. Note that a group may hold many records
+			// of the same ticker (e.g. ticks with equal timestamps), they are passed in the order of their files
+			template<typename MdssT, typename GroupCbT, typename = ::std::enable_if_t<utils::is_tag_of_v<tag_MarketDataStorServ_t, MdssT>>>
+			void operator()(MdssT& m, GroupCbT&& onGroupEnd) {
 				typedef decltype(makeCtxStor(typename MdssT::TickersTuple_t())) CtxStor_t;
 
+				if (m_nParsingThreads && m_maxOpenFiles) {
+					T18_ASSERT(!"Pipelined parsing and the open files limit can't be used together");
+					throw ::std::logic_error("multiFile: pipelined parsing and the open files limit can't be used together");
+				}
+				//must outlive contexts
+				::std::unique_ptr<_i::filePool> pFilePool;
+				if (m_maxOpenFiles) pFilePool = ::std::make_unique<_i::filePool>(m_maxOpenFiles);
+
 				CtxStor_t ctxStor;
 				//0.resizing ctx's to correct size
 				const auto tickersCnt = m.tickersCountByType();
@@ -239,27 +363,42 @@ namespace t18 {
 				});
 
 				//1. opening files & initializing contexts
-				readingCtx rctx;
-				const ::std::string libPath(::std::string(m_libPath) + "/");
-				m.forEachTickerIndexed([&ctxStor, &rctx, &libPath, ths=this](auto& tickr, auto&& typeIdIdx) {
+				runSetup setup{ ::std::string(m_libPath) + "/", m_fileExt, m_nParsingThreads ? m_parsingQueueSize : 0, {}
+					, pFilePool.get(), m_readAheadRecords, m_bTrustCertified };
+				m.forEachTickerIndexed([&ctxStor, &setup, ths=this](auto& tickr, auto&& typeIdIdx) {
 					//typedef ::std::decay_t<decltype(tickr)> ticker_t;
 					T18_ASSERT(tickr.getTickerId().getTypeId() == typeIdIdx);
 
 					typedef ::std::decay_t<decltype(tickr)> ticker_t;
 
 					//almost template-less function
-					self_t::_sInitCtxs(ths->template _getAdapter<ticker_t>(), hana::at(ctxStor, typeIdIdx), rctx, libPath, tickr.getTickerBase());
+					const bool bTrusted = self_t::_sInitCtxs(ths->template _getAdapter<ticker_t>(), hana::at(ctxStor, typeIdIdx), setup
+						, tickr.getTickerBase());
+					if (setup.bTrustCertified) tickr.trustData(bTrusted);
 				});
 
+				//must be destroyed (i.e. stopped) before ctxStor, as workers use files and queues of contexts
+				_i::parsingPool pool;
+				if (!setup.streams.empty()) pool.start(setup.streams, m_nParsingThreads);
 
-				//2. reading/populating market - feeding the earliest bar to the market, reread a new bar and repeat
-				while (rctx.isValid()) {
-					T18_ASSERT(!rctx.tiidOfEarliestTs.isEveryone());
+				mergeHeap heap;
+				heap.m_heap.reserve(m.tickersCount());
+				m.forEachTickerIndexed([&ctxStor, &heap, ths = this](auto& tickr, auto&& typeIdIdx) {
+					typedef ::std::decay_t<decltype(tickr)> ticker_t;
+					self_t::_sReadFirstBar(ths->template _getAdapter<ticker_t>(), hana::at(ctxStor, typeIdIdx), heap, tickr.getTickerBase());
+				});
+
+
+				//2. reading/populating market - feeding the earliest bar to the market, reread a new bar of the same ticker,
+				// return it to the heap and repeat
+				while (!heap.empty()) {
+					const auto e = heap.pop();
+					T18_ASSERT(!e.tiid.isEveryone());
 
-					m.template exec4TickerIndexed<false>(rctx.tiidOfEarliestTs, [&rctx, &ctxStor, &m, ths=this](auto& tickr, auto&& typeIdIdx) {
+					m.template exec4TickerIndexed<false>(e.tiid, [&e, &heap, &ctxStor, &m, ths=this](auto& tickr, auto&& typeIdIdx) {
 						auto &vCtx = hana::at(ctxStor, typeIdIdx);
 						auto& ctxToUse = vCtx[tickr.getTickerId().getIdx()];
-						T18_ASSERT(invalidTs != ctxToUse.bar.TS());
+						T18_ASSERT(e.ts == ctxToUse.bar.TS());
 
 						typedef ::std::decay_t<decltype(tickr)> ticker_t;
 						auto& adpt = ths->template _getAdapter<ticker_t>();
@@ -268,17 +407,18 @@ namespace t18 {
 						//m.newBarClose(tickr, ctxToUse.bar);
 						adpt.updateMkt(m, tickr, ctxToUse.bar);
 
-						//now we must find the earliest already read bar and then read new bar into ctxToUse
-						ctxToUse.bar.TS() = invalidTs;
-						rctx.reset();
-
-						m.forEachTickerIndexed([&ctxStor, &rctx](auto& tickr2, auto&& typeIdIdx2) {
-							_sUpdateCtxs(hana::at(ctxStor, typeIdIdx2), rctx, tickr2.getTickerBase());							
-						});				
+						//new we must read a new bar into the ctxToUse
+						if (sReadBar(adpt, ctxToUse, tickr.getTickerBase())) {
+							if (UNLIKELY(ctxToUse.bar.TS() < e.ts)) {
+								T18_ASSERT(!"Timestamps of a file aren't sorted");
+								throw ::std::runtime_error("Timestamps aren't sorted in the file of ticker "s + tickr.Name()
+									+ " at line#" + ::std::to_string(ctxToUse.nLinesRead));
+							}
+							heap.push({ ctxToUse.bar.TS(), e.order, e.tiid });
+						}
+					});
 
-						//new we must read a new bar into the pCtx
-						sReadBar(adpt, ctxToUse, rctx, tickr.getTickerBase());
-					});					
+					if (heap.empty() || heap.top().ts != e.ts) onGroupEnd(e.ts);
 				}
 
 				//doing notify to make sure that all higher-level timeframes are closed 
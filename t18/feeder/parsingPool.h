@@ -0,0 +1,288 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+// worker threads that parse data files of feeder::multiFile ahead of the strategy thread into bounded per-file
+// queues, so the merge stage only pops already parsed records
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <string>
+#include <exception>
+#include <algorithm>
+
+#include "../base.h"
+#include "../utils/spscQueue.h"
+
+namespace t18 {
+	namespace feeder {
+		namespace _i {
+
+			//checks why adapter's readNext() had returned false and throws if it wasn't a proper end of file
+			inline void checkEndOfRecords(bool isEOF, int nRead, const ::std::string& tickerName, size_t nLine) {
+				if (LIKELY(isEOF)) {
+					if (UNLIKELY(EOF != nRead)) {
+						T18_ASSERT(!"Invalid end of file!");
+						throw ::std::runtime_error("Invalid end of csv for ticker "s + tickerName
+							+ " at line#" + ::std::to_string(nLine) + " read "
+							+ ::std::to_string(nRead) + " !=0 elements");
+					}
+				} else {
+					T18_ASSERT(!"Failed to read csv line");
+					throw ::std::runtime_error("Failed to read csv for ticker "s + tickerName
+						+ " line #"s + ::std::to_string(nLine) + ". Read only "
+						+ ::std::to_string(nRead) + "!=tsohlcv::numOfCsvElements elements");
+				}
+			}
+
+			//a thread blocks on the event until the other side signals it or the wait condition becomes true.
+			//signal() costs only a fence and a load while nobody waits, so it's fine to call it on every queue operation
+			class wakeEvent {
+			protected:
+				::std::mutex m_mtx;
+				::std::condition_variable m_cv;
+				::std::atomic<bool> m_bWaiting{ false };
+				bool m_bSignalled = false;
+
+			public:
+				//the change of the state that ReadyF checks must be followed by signal() to wake the waiter
+				template<typename ReadyF>
+				void wait(ReadyF&& ready) {
+					::std::unique_lock<::std::mutex> lk(m_mtx);
+					m_bWaiting.store(true, ::std::memory_order_relaxed);
+					//pairs with the fence in signal(): either the waiter sees the new state in ready(), or the signaller
+					// sees m_bWaiting and takes the mutex
+					::std::atomic_thread_fence(::std::memory_order_seq_cst);
+					m_cv.wait(lk, [this, &ready]() { return m_bSignalled || ready(); });
+					m_bSignalled = false;
+					m_bWaiting.store(false, ::std::memory_order_relaxed);
+				}
+
+				void signal()noexcept {
+					::std::atomic_thread_fence(::std::memory_order_seq_cst);
+					if (m_bWaiting.load(::std::memory_order_relaxed)) {
+						{
+							::std::lock_guard<::std::mutex> lk(m_mtx);
+							m_bSignalled = true;
+						}
+						m_cv.notify_one();
+					}
+				}
+			};
+
+			//a source of already parsed records of a ticker, that multiFile uses instead of reading the file directly
+			template<typename BarT>
+			class recordSource {
+			public:
+				virtual ~recordSource() {}
+
+				//returns false when there's no more records
+				virtual bool pop(BarT& v) = 0;
+			};
+
+			//producer side of a stream of parsed records, it's pumped by a worker thread of parsingPool
+			class parsedStreamBase {
+			public:
+				enum class pumpResult { full, progressed, finished };
+
+				virtual ~parsedStreamBase() {}
+
+			protected:
+				//event of the worker thread that pumps the stream, the consumer signals it when it frees a place
+				wakeEvent* m_pProducerEv = nullptr;
+
+			public:
+				//reads records until the queue is full or the data is over. Must never block.
+				virtual pumpResult pump()noexcept = 0;
+
+				//producer side. Whether pump() would be able to push a record
+				virtual bool hasRoom()const noexcept = 0;
+
+				void setProducerEvent(wakeEvent* pEv)noexcept { m_pProducerEv = pEv; }
+			};
+
+			//consumer side of a stream
+			template<typename BarT>
+			class parsedQueue : public parsedStreamBase, public recordSource<BarT> {
+			public:
+				typedef BarT bar_t;
+
+			protected:
+				utils::spscQueue<bar_t> m_q;
+				::std::atomic<bool> m_bDone{ false };
+				//set by the producer before m_bDone
+				::std::exception_ptr m_err;
+				//the producer signals it after every push and on the end of the stream
+				wakeEvent m_evData;
+
+			public:
+				explicit parsedQueue(size_t cap) : m_q(cap) {}
+
+				//waits for the next record. Returns false on the end of the stream and rethrows an error that happened
+				// during parsing.
+				virtual bool pop(bar_t& v) override {
+					while (!m_q.tryPop(v)) {
+						if (m_bDone.load(::std::memory_order_acquire)) {
+							//the last records could have been pushed right before the flag was set
+							if (m_q.tryPop(v)) break;
+							if (m_err) ::std::rethrow_exception(m_err);
+							return false;
+						}
+						m_evData.wait([this]() { return !m_q.empty() || m_bDone.load(::std::memory_order_acquire); });
+					}
+					if (m_pProducerEv) m_pProducerEv->signal();
+					return true;
+				}
+
+				virtual bool hasRoom()const noexcept override { return !m_q.full(); }
+
+			protected:
+				void _finish()noexcept {
+					m_bDone.store(true, ::std::memory_order_release);
+					m_evData.signal();
+				}
+			};
+
+			//the adapter must allow concurrent readNext() calls for different files (stock adapters are stateless)
+			template<typename AdptT, typename FileT>
+			class parsedStream : public parsedQueue<typename AdptT::value_t> {
+				typedef parsedQueue<typename AdptT::value_t> base_class_t;
+
+			public:
+				using typename base_class_t::bar_t;
+				using typename parsedStreamBase::pumpResult;
+
+			protected:
+				AdptT& m_adpt;
+				FileT& m_f;
+				const ::std::string m_tickerName;
+				size_t m_nLinesRead = 0;
+
+			public:
+				parsedStream(AdptT& adpt, FileT& f, const ::std::string& tickerName, size_t queueSize)
+					: base_class_t(queueSize), m_adpt(adpt), m_f(f), m_tickerName(tickerName)
+				{}
+
+				virtual pumpResult pump()noexcept override {
+					T18_ASSERT(!base_class_t::m_bDone.load(::std::memory_order_relaxed) && m_f.isOpened());
+					bool bProgressed = false;
+					try {
+						bar_t v;
+						int nRead;
+						while (!base_class_t::m_q.full()) {
+							++m_nLinesRead;
+							if (!m_adpt.readNext(m_f, v, nRead)) {
+								const bool isEOF = feof(m_f);
+								m_f.close();
+								checkEndOfRecords(isEOF, nRead, m_tickerName, m_nLinesRead);
+								base_class_t::_finish();
+								return pumpResult::finished;
+							}
+							base_class_t::m_q.tryPush(v);
+							base_class_t::m_evData.signal();
+							bProgressed = true;
+						}
+					} catch (...) {
+						base_class_t::m_err = ::std::current_exception();
+						base_class_t::_finish();
+						return pumpResult::finished;
+					}
+					return bProgressed ? pumpResult::progressed : pumpResult::full;
+				}
+			};
+
+			//a fixed set of worker threads, each one is pumping its own share of streams until all of them are finished.
+			//A worker sleeps while all its queues are full, consumers wake it up when they pop a record
+			class parsingPool {
+			protected:
+				::std::vector<::std::thread> m_threads;
+				//one per thread
+				::std::vector<::std::unique_ptr<wakeEvent>> m_events;
+				::std::atomic<bool> m_bStop{ false };
+
+			protected:
+				void _work(::std::vector<parsedStreamBase*>& streams, wakeEvent& ev)noexcept {
+					while (!streams.empty() && !m_bStop.load(::std::memory_order_relaxed)) {
+						bool bProgressed = false;
+						for (size_t i = 0; i < streams.size();) {
+							const auto r = streams[i]->pump();
+							if (parsedStreamBase::pumpResult::finished == r) {
+								streams[i] = streams.back();
+								streams.pop_back();
+								bProgressed = true;
+							} else {
+								if (parsedStreamBase::pumpResult::progressed == r) bProgressed = true;
+								++i;
+							}
+						}
+						//every queue is full, waiting for the consumer
+						if (!bProgressed) {
+							ev.wait([this, &streams]() {
+								return m_bStop.load(::std::memory_order_relaxed)
+									|| ::std::any_of(streams.begin(), streams.end(), [](const parsedStreamBase* p) { return p->hasRoom(); });
+							});
+						}
+					}
+				}
+
+			public:
+				parsingPool() = default;
+				parsingPool(const parsingPool&) = delete;
+				parsingPool& operator=(const parsingPool&) = delete;
+
+				~parsingPool()noexcept {
+					stop();
+				}
+
+				//streams must outlive the pool (or the stop() call)
+				void start(const ::std::vector<parsedStreamBase*>& streams, size_t nThreads) {
+					T18_ASSERT(m_threads.empty() && nThreads > 0);
+					nThreads = ::std::min(nThreads, streams.size());
+					m_bStop.store(false, ::std::memory_order_relaxed);
+					m_threads.reserve(nThreads);
+					m_events.reserve(nThreads);
+					for (size_t t = 0; t < nThreads; ++t) {
+						m_events.push_back(::std::make_unique<wakeEvent>());
+						auto& ev = *m_events.back();
+						::std::vector<parsedStreamBase*> part;
+						for (size_t i = t; i < streams.size(); i += nThreads) {
+							streams[i]->setProducerEvent(&ev);
+							part.push_back(streams[i]);
+						}
+						m_threads.emplace_back([this, &ev, part = ::std::move(part)]() mutable { _work(part, ev); });
+					}
+				}
+
+				void stop()noexcept {
+					m_bStop.store(true, ::std::memory_order_relaxed);
+					for (auto& pEv : m_events) pEv->signal();
+					for (auto& t : m_threads) {
+						if (t.joinable()) t.join();
+					}
+					m_threads.clear();
+					m_events.clear();
+				}
+			};
+
+		}
+	}
+}
@@ -0,0 +1,154 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "../base.h"
+#include "../tags.h"
+#include "memory.h"
+
+namespace t18 {
+	namespace feeder {
+
+		//sharedHistory is an immutable reference-counted history of a single ticker, that is built once and then shared
+		// by any number of (concurrently running) backtests. Copying the object is cheap as it copies a pointer only, so
+		// every run could just take its own copy and replay it (whole or a range of it) into its own market.
+		// Besides the source data, a sharedHistory could also be created by a one-time conversion of another
+		// sharedHistory to a higher timeframe with convert(). If a trading system needs only the higher timeframe
+		// data, feeding it directly from the converted history frees every run from repeating the same timeframe conversion.
+		// Note that intraday (intrabar) events, that would be emitted during a normal conversion, are lost in that case.
+		template<typename ValT>
+		class sharedHistory {
+		public:
+			typedef ValT value_type;
+			typedef sharedHistory<value_type> self_t;
+			typedef ::std::vector<value_type> data_t;
+
+			static constexpr bool bTicks = ::std::is_base_of_v<tsTick, value_type>;
+
+		protected:
+			::std::shared_ptr<const data_t> m_pData;
+
+		public:
+			sharedHistory() {}
+			explicit sharedHistory(data_t&& d) : m_pData(::std::make_shared<const data_t>(::std::move(d))) {}
+			explicit sharedHistory(memory<value_type>&& m) : sharedHistory(m.release()) {}
+
+			//see memory::make()
+			template< template<class> typename SrcFeederTpl, typename FeederAdptT, typename FeederArgsHTupleT, typename AdptArgsHTupleT>
+			static self_t make(FeederArgsHTupleT&& feederArgsTuple, AdptArgsHTupleT&& adptArgsTuple) {
+				return self_t(memory<value_type>::template make<SrcFeederTpl, FeederAdptT>(
+					::std::forward<FeederArgsHTupleT>(feederArgsTuple), ::std::forward<AdptArgsHTupleT>(adptArgsTuple)));
+			}
+
+			bool empty()const noexcept { return !m_pData || m_pData->empty(); }
+			size_t size()const noexcept { return m_pData ? m_pData->size() : 0; }
+			//number of objects that share the same data
+			long use_count()const noexcept { return m_pData.use_count(); }
+
+			const value_type& operator[](size_t i)const noexcept {
+				T18_ASSERT(i < size());
+				return (*m_pData)[i];
+			}
+			const value_type& front()const noexcept { return (*this)[0]; }
+			const value_type& back()const noexcept { return (*this)[size() - 1]; }
+
+			//returns an index of the first element with timestamp >= ts, or size() if there's no such element
+			size_t lowerBound(mxTimestamp ts)const noexcept {
+				if (empty()) return 0;
+				return static_cast<size_t>(::std::lower_bound(m_pData->begin(), m_pData->end(), ts
+					, [](const value_type& e, mxTimestamp t)noexcept { return e.TS() < t; }) - m_pData->begin());
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			//runs the converter conv over the data once and returns a new history of bars of the converted timeframe.
+			// The sequence of calls to the converter is the same as timeseries::timeframeStor does.
+			template<typename TfConvT>
+			auto convert(TfConvT&& conv)const {
+				typedef typename ::std::decay_t<TfConvT>::bar_t bar_t;
+				typename sharedHistory<bar_t>::data_t r;
+				if (empty()) return sharedHistory<bar_t>(::std::move(r));
+
+				for (const auto& e : *m_pData) {
+					const bar_t* pBtc = conv.shouldCloseCurBar(e.TS());
+					if (pBtc) r.push_back(*pBtc);
+
+					if constexpr(bTicks) {
+						if (!conv.isReallyNewBarOpen(e)) conv.aggregate(e);
+					} else {
+						conv.isReallyNewBarOpen(e.TSQ());
+						conv.aggregate(e);
+					}
+				}
+				//closing the last bar
+				const bar_t* pBtc = conv.shouldCloseCurBar(back().TS().plusYear());
+				if (pBtc) r.push_back(*pBtc);
+
+				return sharedHistory<bar_t>(::std::move(r));
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			//replays elements [from, to) into srv (see tickerUpdater). If bNotifyEnd is set, the srv.notifyDateTime() is
+			// called afterwards to make sure that all higher-level timeframes are closed
+			template<typename SrvT>
+			void feed(SrvT&& srv, size_t from, size_t to, const bool bNotifyEnd = true)const {
+				T18_ASSERT(from <= to && to <= size());
+				if (from >= to) return;
+
+				const auto& d = *m_pData;
+				for (size_t i = from; i < to; ++i) {
+					const auto& e = d[i];
+					if constexpr(bTicks) {
+						srv.newTick(e);
+					} else {
+						srv.newBarOpen(e.TSQ());
+						srv.newBarAggregate(e);
+					}
+				}
+				if (bNotifyEnd) srv.notifyDateTime(d[to - 1].TS().plusYear());
+			}
+
+			template<typename SrvT>
+			void feed(SrvT&& srv)const {
+				T18_ASSERT(!empty());
+				feed(::std::forward<SrvT>(srv), 0, size());
+			}
+
+			//to be called by backtester
+			template<typename MdssT>
+			::std::enable_if_t<utils::has_tag_t_v<tag_MarketDataStorServ_t, MdssT>> operator()(MdssT& mkt)const {
+				if (mkt.tickersCount() != 1) {
+					T18_ASSERT(!"sharedHistory class supports feeding into only 1 ticker");
+					throw ::std::logic_error("sharedHistory class supports feeding into only 1 ticker");
+				}
+				mkt.forEachTicker([&mkt, ths = this](auto& tickr) {
+					ths->operator()(mkt, tickr);
+				});
+			}
+
+			template<typename MktT, typename TServT>
+			void operator()(MktT& m, TServT& t)const {
+				feed(tickerUpdater<MktT, TServT>(m, t));
+			}
+		};
+
+	}
+}
@@ -0,0 +1,257 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <queue>
+#include <functional>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#include "../base.h"
+#include "../market/tickerBase.h"
+#include "adapters/csv.h"
+#include "singleFile.h"
+#include "sharedHistory.h"
+
+namespace t18 {
+	namespace feeder {
+
+		//sharedTimeline is an immutable reference-counted multi ticker counterpart of sharedHistory. Histories of all
+		// tickers are loaded once and merged into a single timeline by timestamps. Records with equal timestamps are fed
+		// in the order of tickers of the market being fed, just as multiFile does. The timeline could then be replayed any number of times into fresh markets,
+		// so optimization sweeps pay for parsing and merging once per process instead of once per run.
+		// Copying the object is cheap, every (concurrently running) backtest should just take its own copy.
+		//AdptT is a feeder::adapter that is used to load files and to update the market (just like in multiFile)
+		template<typename AdptT = adapters::csv_tsohlcv>
+		class sharedTimeline {
+		public:
+			typedef AdptT adapter_t;
+			typedef typename adapter_t::value_t value_type;
+			typedef sharedTimeline<adapter_t> self_t;
+			typedef sharedHistory<value_type> history_t;
+			//index of a ticker in the timeline
+			typedef ::std::uint32_t tickerIdx_t;
+
+		protected:
+			struct data_t {
+				::std::vector<::std::string> names;
+				::std::vector<history_t> hists;
+				//index of a ticker for every record of the timeline. Records of each ticker go in order of its history,
+				// so the index of the record in the history is implicit. Records with equal timestamps are ordered by
+				// the ticker index here, the feeding reorders them by the market order if necessary
+				::std::vector<tickerIdx_t> order;
+			};
+
+			inline static constexpr mxTimestamp invalidTs = mxTimestamp::max();
+
+		protected:
+			::std::shared_ptr<const data_t> m_pData;
+			adapter_t m_adapter;
+
+		protected:
+			static void _merge(data_t& d) {
+				typedef ::std::pair<mxTimestamp, tickerIdx_t> entry_t;
+				::std::priority_queue<entry_t, ::std::vector<entry_t>, ::std::greater<entry_t>> heap;
+
+				size_t total = 0;
+				for (size_t i = 0; i < d.hists.size(); ++i) {
+					const auto& h = d.hists[i];
+					total += h.size();
+					if (!h.empty()) heap.emplace(h.front().TS(), static_cast<tickerIdx_t>(i));
+				}
+				d.order.reserve(total);
+
+				::std::vector<size_t> cur(d.hists.size(), 0);
+				while (!heap.empty()) {
+					const auto e = heap.top();
+					heap.pop();
+					d.order.push_back(e.second);
+
+					const auto& h = d.hists[e.second];
+					const auto n = ++cur[e.second];
+					if (n < h.size()) {
+						if (UNLIKELY(h[n].TS() < e.first)) {
+							T18_ASSERT(!"Timestamps of a history aren't sorted");
+							throw ::std::runtime_error("Timestamps aren't sorted in the history of ticker "s
+								+ d.names[e.second] + " at record#" + ::std::to_string(n));
+						}
+						heap.emplace(h[n].TS(), e.second);
+					}
+				}
+				T18_ASSERT(d.order.size() == total);
+			}
+
+		public:
+			sharedTimeline() {}
+
+			//makes the timeline from the given histories, names[i] is a name of the ticker of the hists[i]
+			sharedTimeline(::std::vector<::std::string>&& names, ::std::vector<history_t>&& hists, adapter_t adpt = adapter_t())
+				: m_adapter(::std::move(adpt))
+			{
+				if (names.size() != hists.size()) {
+					T18_ASSERT(!"Number of names and histories must be the same");
+					throw ::std::logic_error("sharedTimeline: number of names and histories must be the same");
+				}
+				if (names.size() > ::std::numeric_limits<tickerIdx_t>::max()) {
+					T18_ASSERT(!"Too many tickers");
+					throw ::std::logic_error("sharedTimeline: too many tickers");
+				}
+				auto pD = ::std::make_shared<data_t>();
+				pD->names = ::std::move(names);
+				pD->hists = ::std::move(hists);
+				_merge(*pD);
+				m_pData = ::std::move(pD);
+			}
+
+			//loads files libPath/<ticker><ext> of the given tickers with the adapter
+			static self_t make(const char* libPath, const ::std::vector<::std::string>& tickers, adapter_t adpt = adapter_t()
+				, const char* ext = ".csv")
+			{
+				T18_ASSERT(libPath && ext);
+				::std::vector<::std::string> names(tickers);
+				::std::vector<history_t> hists;
+				hists.reserve(names.size());
+				const ::std::string path(::std::string(libPath) + "/");
+				for (const auto& n : names) {
+					const ::std::string fname(path + n + ext);
+					if (!utils::myFile::exist(fname.c_str())) {
+						T18_ASSERT(!"Failed to open csv file");
+						throw ::std::runtime_error("Failed to open csv file, path="s + fname);
+					}
+					hists.emplace_back(history_t::template make<singleFile, adapter_t>(hana::make_tuple(fname.c_str()), hana::make_tuple()));
+				}
+				return self_t(::std::move(names), ::std::move(hists), ::std::move(adpt));
+			}
+
+			bool empty()const noexcept { return !m_pData || m_pData->order.empty(); }
+			//total number of records of all tickers
+			size_t size()const noexcept { return m_pData ? m_pData->order.size() : 0; }
+			size_t tickersCount()const noexcept { return m_pData ? m_pData->names.size() : 0; }
+			long use_count()const noexcept { return m_pData.use_count(); }
+
+			const ::std::string& tickerName(size_t i)const noexcept {
+				T18_ASSERT(i < tickersCount());
+				return m_pData->names[i];
+			}
+			const history_t& history(size_t i)const noexcept {
+				T18_ASSERT(i < tickersCount());
+				return m_pData->hists[i];
+			}
+			//returns the index of the ticker or tickersCount() if there's no such ticker
+			size_t findTicker(const char* name)const noexcept {
+				const auto c = tickersCount();
+				for (size_t i = 0; i < c; ++i) {
+					if (m_pData->names[i] == name) return i;
+				}
+				return c;
+			}
+
+			//////////////////////////////////////////////////////////////////////////
+			//to be called by backtester. Every ticker of the market must be present in the timeline (it's matched by name),
+			// however, the timeline may contain more tickers than the market - their records are just skipped.
+			// The sequence of market updates is the same as multiFile makes.
+			template<typename MdssT, typename = ::std::enable_if_t<utils::has_tag_t_v<tag_MarketDataStorServ_t, MdssT>>>
+			void operator()(MdssT& m)const {
+				(*this)(m, [](mxTimestamp)noexcept {});
+			}
+
+			//see multiFile::operator()(m, onGroupEnd)
+			template<typename MdssT, typename GroupCbT, typename = ::std::enable_if_t<utils::has_tag_t_v<tag_MarketDataStorServ_t, MdssT>>>
+			void operator()(MdssT& m, GroupCbT&& onGroupEnd)const {
+				const auto tc = tickersCount();
+				::std::vector<TickerId> tiids(tc, TickerId::forEveryone());
+				//position of a ticker in the market. multiFile feeds records with equal timestamps in this order
+				::std::vector<size_t> ranks(tc, 0);
+				size_t nextRank = 0;
+				m.forEachTicker([&tiids, &ranks, &nextRank, tc, ths = this](auto& tickr) {
+					const auto i = ths->findTicker(tickr.Name());
+					if (i >= tc) {
+						T18_ASSERT(!"No ticker in the timeline");
+						throw ::std::runtime_error("sharedTimeline: there's no data for ticker "s + tickr.Name());
+					}
+					tiids[i] = tickr.getTickerId();
+					ranks[i] = nextRank++;
+				});
+				if (empty()) return;
+
+				//if tickers of the market go in the order of the timeline, records are fed just as they are merged
+				bool bSameOrder = true;
+				for (size_t i = 0, prev = 0; i < tc; ++i) {
+					if (tiids[i].isEveryone()) continue;
+					if (ranks[i] < prev) {
+						bSameOrder = false;
+						break;
+					}
+					prev = ranks[i];
+				}
+
+				const auto& d = *m_pData;
+				//multiFile makes the best bid/ask guess as soon as it reads the next record of a ticker
+				for (size_t i = 0; i < tc; ++i) {
+					if (!tiids[i].isEveryone() && !d.hists[i].empty()) {
+						m.template exec4TickerIndexed<false>(tiids[i], [&h = d.hists[i], ths = this](auto& tickr, auto&&) {
+							ths->m_adapter._setBestGuessBidAsk(tickr.getTickerBase(), h.front().TSQ());
+						});
+					}
+				}
+
+				::std::vector<size_t> cur(tc, 0);
+				//records (ticker, index in its history) of the current timestamp
+				::std::vector<::std::pair<tickerIdx_t, size_t>> group;
+				mxTimestamp lastTs;
+				auto feedGroup = [&]() {
+					//stable, as records of the same ticker must retain their order
+					if (!bSameOrder && group.size() > 1) {
+						::std::stable_sort(group.begin(), group.end(), [&ranks](const auto& a, const auto& b) {
+							return ranks[a.first] < ranks[b.first];
+						});
+					}
+					for (const auto& g : group) {
+						const auto& h = d.hists[g.first];
+						const auto idx = g.second;
+						m.template exec4TickerIndexed<false>(tiids[g.first], [&m, &h, idx, ths = this](auto& tickr, auto&&) {
+							ths->m_adapter.updateMkt(m, tickr, h[idx]);
+							if (idx + 1 < h.size()) ths->m_adapter._setBestGuessBidAsk(tickr.getTickerBase(), h[idx + 1].TSQ());
+						});
+					}
+					group.clear();
+					onGroupEnd(lastTs);
+				};
+
+				for (const auto ti : d.order) {
+					const auto idx = cur[ti]++;
+					if (tiids[ti].isEveryone()) continue;
+
+					const auto ts = d.hists[ti][idx].TS();
+					if (!group.empty() && lastTs != ts) feedGroup();
+					lastTs = ts;
+					group.emplace_back(ti, idx);
+				}
+				if (!group.empty()) feedGroup();
+
+				//doing notify to make sure that all higher-level timeframes are closed 
+				m.notifyDateTime(TickerId::forEveryone(), invalidTs);
+			}
+		};
+
+	}
+}
@@ -19,7 +19,12 @@
 
 //#include "tickerUpdater.h"
 
+#include <map>
+
 #include "../tags.h"
+#include "../utils/myFile.h"
+#include "adapterTraits.h"
+#include "dataCertificate.h"
 
 namespace t18 {
 	namespace feeder {
@@ -34,10 +39,34 @@ namespace t18 {
 		public:
 			typedef AdaptT adapter_t;
 			typedef typename adapter_t::value_t value_t;
+			typedef adapterIndex_t<adapter_t> index_t;
 			
 		protected:
 			adapter_t m_adapter;
 			const char* m_fname = nullptr;
+			//range of timestamps [m_from, m_to) to read. Empty values mean an open range
+			mxTimestamp m_from, m_to;
+			//see trustCertifiedData()
+			bool m_bTrustCertified = false;
+			//indexes of data files already seen by the object, so a sidecar is loaded (or an index is built) only once
+			// per file. See _indexOf()
+			mutable ::std::map<::std::string, index_t> m_indexes;
+
+		protected:
+			const index_t& _indexOf(const char* fname)const {
+				auto it = m_indexes.find(fname);
+				if (it == m_indexes.end()) it = m_indexes.emplace(fname, index_t::forFile(fname)).first;
+				return it->second;
+			}
+
+			//index to seek to m_from in a file or nullptr, when there's no index or seeking isn't needed
+			const index_t* _seekIndexOf(const char* fname)const {
+				if constexpr(adapterHasIndex_v<adapter_t>) {
+					if (!m_from.empty()) return &_indexOf(fname);
+				}
+				(void)fname;
+				return nullptr;
+			}
 
 		public:
 			singleFile(const char* f) :m_fname(f) {}
@@ -55,45 +84,82 @@ namespace t18 {
 					T18_ASSERT(!"singleFile class supports feeding into only 1 ticker");
 					throw ::std::logic_error("singleFile class supports feeding into only 1 ticker");
 				}
-				mkt.forEachTicker([&mkt, _fn = m_fname, &adp = m_adapter](auto& tickr) {
+				mkt.forEachTicker([&mkt, ths = this](auto& tickr) {
 					typedef ::std::decay_t<decltype(tickr)> ticker_t;
 					static_assert(utils::has_tag_t_v<tag_Ticker_t, ticker_t>, "");
 
-					::std::string fn(::std::string(_fn) + "/" + tickr.Name() + ".csv");
-					processFile(mkt, tickr, fn.c_str(), adp);
+					::std::string fn(::std::string(ths->m_fname) + "/" + tickr.Name() + ".csv");
+					if (ths->m_bTrustCertified) tickr.trustData(dataCertificate::isValidFor<adapter_t>(fn.c_str()));
+					processFile(mkt, tickr, fn.c_str(), ths->m_adapter, ths->m_from, ths->m_to, ths->_seekIndexOf(fn.c_str()));
 				});
 			}
 
+			//if set, a ticker is switched to the trusted mode (see tickerServer::trustData()) when its data file has a
+			// matching dataCertificate
+			void trustCertifiedData(bool b = true)noexcept { m_bTrustCertified = b; }
+
+			//restricts the data fed to records with timestamps in [from, to). Empty from or to means an open range.
+			//If the adapter has an index (see adapterHasIndex_v), reading starts near the from timestamp instead of the
+			// beginning of the file
+			void setRange(mxTimestamp from, mxTimestamp to)noexcept {
+				T18_ASSERT(from.empty() || to.empty() || from < to);
+				m_from = from;
+				m_to = to;
+			}
+
+			//for a range it's an upper bound of the records count
 			size_t capacity()const {
-				return m_adapter.capacity(m_fname);
+				if constexpr(adapterHasIndex_v<adapter_t>) {
+					return _indexOf(m_fname).countUpperBound(m_from, m_to);
+				} else {
+					return m_adapter.capacity(m_fname);
+				}
 			}
 
 			void processByAdapter() {
-				processFile(dummyMkt(), 0, m_fname, m_adapter);
+				processFile(dummyMkt(), 0, m_fname, m_adapter, m_from, m_to, _seekIndexOf(m_fname));
 			}
 
 			template<typename MdssT, typename TickerServT, typename AdptT, typename = ::std::enable_if_t<::std::is_same_v<::std::decay_t<AdptT>, adapter_t>>>
-			static void processFile(MdssT&& mkt, TickerServT&& tickr, const char* fname, AdptT&& adpt) {
-				utils::myFile myF(fname, "r");
+			static void processFile(MdssT&& mkt, TickerServT&& tickr, const char* fname, AdptT&& adpt
+				, const mxTimestamp from = mxTimestamp(), const mxTimestamp to = mxTimestamp(), const index_t* pIdx = nullptr)
+			{
+				adapterFile_t<AdptT> myF(fname, "r");
+				if constexpr(adapterHasIndex_v<AdptT>) {
+					//pIdx is a cached index of the file (if any); without it the index is loaded/built on the spot
+					if (!from.empty()) {
+						myF.seek(pIdx ? pIdx->offsetBefore(from) : index_t::forFile(fname).offsetBefore(from));
+					}
+				} else {
+					(void)pIdx;
+				}
 
 				size_t nLines = 0;
 				value_t val;
 				int nRead;
+				bool bStopped = false;
 
 				while (adpt.readNext(myF, val, nRead)) {
 					++nLines;
+					if (!from.empty() && val.TS() < from) continue;
+					if (!to.empty() && val.TS() >= to) {
+						bStopped = true;
+						break;
+					}
 					adpt.updateMkt(mkt, tickr, val);
 				}
-				if (feof(myF)) {
-					if (EOF != nRead) {
-						T18_ASSERT(!"Invalid end of file!");
-						throw ::std::runtime_error("Invalid end of file, after "s + ::std::to_string(nLines) + " read "
-							+ ::std::to_string(nRead) + " !=0 elements");
+				if (!bStopped) {
+					if (feof(myF)) {
+						if (EOF != nRead) {
+							T18_ASSERT(!"Invalid end of file!");
+							throw ::std::runtime_error("Invalid end of file, after "s + ::std::to_string(nLines) + " read "
+								+ ::std::to_string(nRead) + " !=0 elements");
+						}
+					} else {
+						T18_ASSERT(!"Failed to read csv line");
+						throw ::std::runtime_error("Failed to read csv line #"s + ::std::to_string(nLines + 1) + ". Read only "
+							+ ::std::to_string(nRead) + " elements");
 					}
-				} else {
-					T18_ASSERT(!"Failed to read csv line");
-					throw ::std::runtime_error("Failed to read csv line #"s + ::std::to_string(nLines + 1) + ". Read only "
-						+ ::std::to_string(nRead) + " elements");
 				}
 
 				//doing notify to make sure that all higher-level timeframes are closed 
@@ -0,0 +1,180 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include "../base.h"
+#include "../tags.h"
+#include "../utils/myFile.h"
+#include "../utils/fileWatcher.h"
+#include "adapters/fastCsv.h"
+#include "tickerUpdater.h"
+
+namespace t18 {
+	namespace feeder {
+
+		//tailFile feeds a single ticker from a csv file, that is being appended by another process (paper trading, shadow
+		// runs). It feeds the whole history first and then sleeps in utils::fileWatcher until the file grows, so the new
+		// records are fed as soon as they are written. Only complete lines are parsed, a partially written line waits for
+		// its ending. The feeding ends when stop() is called from another thread; truncation or replacement of the file
+		// isn't supported.
+		//AdptT must be able to parse a single line with parseRecord() (see adapters/fastCsv.h)
+		template<typename AdptT = adapters::fastCsv_tsohlcv>
+		class tailFile {
+		public:
+			typedef AdptT adapter_t;
+			typedef typename adapter_t::value_t value_t;
+
+			static constexpr bool bTicks = ::std::is_base_of_v<tsTick, value_t>;
+			static constexpr size_t defaultBlockSize = 64 * 1024;
+
+		protected:
+			adapter_t m_adapter;
+			const ::std::string m_fname;
+			//must be set up before the file is read the first time to not miss any change
+			utils::fileWatcher m_watcher;
+			::std::atomic<bool> m_bStop{ false };
+
+			//the data read, that doesn't contain a complete line yet
+			::std::vector<char> m_buf;
+			size_t m_bufLen = 0;
+			const size_t m_blockSize;
+
+			size_t m_nLines = 0;
+			size_t m_nFed = 0;
+			mxTimestamp m_lastTs;
+
+		protected:
+			static bool _isBlank(const char* b, const char* e)noexcept {
+				while (b < e && (' ' == *b || '\t' == *b || '\r' == *b)) ++b;
+				return b == e;
+			}
+
+			template<typename SrvT>
+			void _feedRecord(SrvT& srv, const value_t& v) {
+				if constexpr(bTicks) {
+					srv.newTick(v);
+				} else {
+					srv.newBarOpen(v.TSQ());
+					srv.newBarAggregate(v);
+				}
+				m_lastTs = v.TS();
+				++m_nFed;
+			}
+
+			//reads everything that has been appended to the file since the last call and feeds all complete lines. Stops
+			// after the current block if stop() was called. Returns false if there was no new data
+			template<typename SrvT>
+			bool _readAppended(FILE* pF, SrvT& srv) {
+				//the EOF state is sticky, but the file might have grown since
+				clearerr(pF);
+				bool bGot = false;
+				while (true) {
+					if (m_buf.size() - m_bufLen < m_blockSize) m_buf.resize(m_bufLen + m_blockSize);
+					const size_t n = fread(m_buf.data() + m_bufLen, 1, m_buf.size() - m_bufLen, pF);
+					if (!n) break;
+					bGot = true;
+					m_bufLen += n;
+
+					const char* b = m_buf.data();
+					const char*const e = b + m_bufLen;
+					const char* pNl;
+					while (nullptr != (pNl = static_cast<const char*>(::std::memchr(b, '\n', static_cast<size_t>(e - b))))) {
+						++m_nLines;
+						if (!_isBlank(b, pNl)) {
+							value_t v;
+							int nRead;
+							if (UNLIKELY(!m_adapter.parseRecord(b, pNl, v, nRead))) {
+								T18_ASSERT(!"Failed to parse a line");
+								throw ::std::runtime_error("tailFile: failed to parse line #"s + ::std::to_string(m_nLines)
+									+ " of " + m_fname + ", read only " + ::std::to_string(nRead) + " elements");
+							}
+							_feedRecord(srv, v);
+						}
+						b = pNl + 1;
+					}
+					//moving the incomplete line to the beginning
+					m_bufLen = static_cast<size_t>(e - b);
+					if (m_bufLen) ::std::memmove(m_buf.data(), b, m_bufLen);
+					//a writer that never pauses mustn't keep us here
+					if (stopped()) break;
+				}
+				if (UNLIKELY(ferror(pF))) {
+					T18_ASSERT(!"Failed to read the file");
+					throw ::std::runtime_error("tailFile: failed to read " + m_fname);
+				}
+				return bGot;
+			}
+
+		public:
+			tailFile(const char* fname, adapter_t a = adapter_t(), size_t blockSize = defaultBlockSize)
+				: m_adapter(::std::move(a)), m_fname(fname), m_watcher(fname), m_blockSize(blockSize)
+			{
+				T18_ASSERT(blockSize > 0);
+			}
+
+			//makes the feeding to return as soon as the block of data being read is fed. Could be called from any thread
+			void stop()noexcept {
+				m_bStop.store(true, ::std::memory_order_release);
+				m_watcher.stop();
+			}
+			bool stopped()const noexcept { return m_bStop.load(::std::memory_order_acquire); }
+
+			//count of records fed so far
+			size_t recordsFed()const noexcept { return m_nFed; }
+
+			//feeds the history and then the appended data into srv (see tickerUpdater) until stop() is called. If bNotifyEnd
+			// is set, the srv.notifyDateTime() is called afterwards to make sure that all higher-level timeframes are closed
+			template<typename SrvT>
+			void feed(SrvT&& srv, const bool bNotifyEnd = true) {
+				//the writer must be able to append to the file while it's opened here
+				utils::myFile myF;
+				myF.openShared(m_fname.c_str(), "rb");
+				while (true) {
+					const bool bGot = _readAppended(myF, srv);
+					if (stopped()) break;
+					if (!bGot) m_watcher.wait();
+				}
+				if (bNotifyEnd && m_nFed) srv.notifyDateTime(m_lastTs.plusYear());
+			}
+
+			//to be called by backtester
+			template<typename MdssT>
+			::std::enable_if_t<utils::has_tag_t_v<tag_MarketDataStorServ_t, MdssT>> operator()(MdssT& mkt) {
+				if (mkt.tickersCount() != 1) {
+					T18_ASSERT(!"tailFile class supports feeding into only 1 ticker");
+					throw ::std::logic_error("tailFile class supports feeding into only 1 ticker");
+				}
+				mkt.forEachTicker([&mkt, ths = this](auto& tickr) {
+					ths->operator()(mkt, tickr);
+				});
+			}
+
+			template<typename MktT, typename TServT>
+			void operator()(MktT& m, TServT& t) {
+				feed(tickerUpdater<MktT, TServT>(m, t));
+			}
+		};
+
+	}
+}
@@ -36,6 +36,12 @@ namespace t18 {
 			void newBarAggregate(typename TServT::bar_t const& bar) {
 				m.newBarAggregate(t, bar);
 			}
+			void newTick(const tsTick& tst) {
+				m.newTick(t, tst);
+			}
+			void newTick(const tsDeal& d) {
+				m.newTick(t, d);
+			}
 		};
 
 	}
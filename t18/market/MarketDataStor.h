@@ -233,6 +233,28 @@ namespace t18 {
 			return hana::size(m_TickerStor);
 		}
 
+	protected:
+		//destroys all tickers
+		void _clearTickers()noexcept {
+			hana::for_each(m_TickerStor, [](auto& cont)noexcept {
+				cont.clear();
+			});
+		}
+
+	public:
+
+		//the report is a tree: MarketDataStor -> tickers -> timeframes -> timeseries columns
+		::utils::memFootprint memoryFootprint(const char* name = "MarketDataStor")const {
+			::utils::memFootprint r(name, sizeof(self_t));
+			hana::for_each(m_TickerStor, [&r](const auto& cont) {
+				r.bytes += ::utils::heapBytes(cont);
+				for (const auto& ptr : cont) {
+					if (ptr) r.add(ptr->memoryFootprint());
+				}
+			});
+			return r;
+		}
+
 	protected:
 		template<typename F>
 		void _forEachTickerIndexed(F&& f) {
@@ -62,6 +62,20 @@ namespace t18 {
 		}
 
 		//////////////////////////////////////////////////////////////////////////
+	protected:
+		//drops the data of every ticker, but keeps the tickers (see tickerServer::_reset())
+		void _resetData()noexcept {
+			this->forEachTicker([](auto& Tickr)noexcept {
+				Tickr._reset();
+			});
+			T18_DEBUG_ONLY(m_latestTS = mxTimestamp(1901, 1, 1, 1, 1, 1));
+		}
+		//destroys all tickers
+		void _clearTickers()noexcept {
+			base_class_t::_clearTickers();
+			T18_DEBUG_ONLY(m_latestTS = mxTimestamp(1901, 1, 1, 1, 1, 1));
+		}
+
 	public:
 		//interface to update ticker data
 		//at first glance it seems that notifyDateTime should broadcast the dt to every ticker.
@@ -133,6 +147,23 @@ namespace t18 {
 			Tickr._newTick_post();
 		}
 
+		//the same as newTick(), but keeps the deal number and the aggressor side if the ticker stores them
+		// (see tickerServer::enableDealsHistory())
+		void newTick(TickerId tiid, const tsDeal& d) {
+			this->exec4Ticker<false>(tiid, [&d, ths = this](auto& Tickr) {
+				ths->newTick(Tickr, d);
+			});
+		}
+		template<typename TickerT, typename = ::std::enable_if<::std::is_same_v<tag_Ticker_t, typename TickerT::tag_t>>>
+		void newTick(TickerT& Tickr, const tsDeal& d) {
+			T18_ASSERT(m_latestTS <= d.TS());
+			T18_DEBUG_ONLY(m_latestTS = d.TS());
+
+			Tickr._newTick_pre(d);
+			Tickr._newTick(d);
+			Tickr._newTick_post();
+		}
+
 		//////////////////////////////////////////////////////////////////////////
 		
 		template<typename TB, typename TA, typename
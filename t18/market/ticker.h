@@ -19,6 +19,7 @@
 
 //#include <forward_list>
 #include "../timeseries/Timeframe.h"
+#include "../timeseries/dealsStor.h"
 #include "tickerBase.h"
 
 namespace t18 {
@@ -76,6 +77,9 @@ namespace t18 {
 
 	protected:
 		timeframesDm_t m_tfsMap;
+
+		//optional history of deals, see tickerServer::enableDealsHistory()
+		::std::unique_ptr<timeseries::dealsStor> m_pDeals;
 		
 	protected:
 		//class is not intended to be instantiated directly
@@ -201,6 +205,20 @@ namespace t18 {
 		template<typename TfIdT>
 		const auto& getTf()const noexcept { return getTf(TfIdT()); }
 
+		//returns nullptr if the deals history isn't enabled
+		const timeseries::dealsStor* getDeals()const noexcept { return m_pDeals.get(); }
+
+		//timeframes are reported as children named by their keys. Timeframes that aren't created are skipped
+		::utils::memFootprint memoryFootprint()const {
+			::utils::memFootprint r(m_Name, sizeof(self_t));
+			hana::for_each(m_tfsMap, [&r](const auto& pr) {
+				const auto& p = hana::second(pr);
+				if (p) r.add(p->memoryFootprint(hana::first(pr).c_str()));
+			});
+			if (m_pDeals) r.add(m_pDeals->memoryFootprint());
+			return r;
+		}
+
 		//we definitely need a way to compare for equality of two ticker objects
 		constexpr bool operator==(const self_t& r)const noexcept { return this == &r; }
 		constexpr bool operator!=(const self_t& r)const noexcept { return this != &r; }
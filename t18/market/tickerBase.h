@@ -57,6 +57,13 @@ namespace t18 {
 
 		//aka TickSize. MUST be set on construction
 		real_t m_minPriceDelta;
+		//converts prices to a number of m_minPriceDelta ticks and back
+		priceTicks m_priceTicks;
+		//if set, every incoming price is moved to the nearest canonical value on the price grid (see tickerServer::snapPricesToTicks())
+		bool m_bSnapPrices{ false };
+		//if set, the incoming data is known to be valid and ordered, so per record sanity checks are skipped
+		// (see tickerServer::trustData())
+		bool m_bTrustedData{ false };
 
 		mxTime m_endOfSession;
 		int m_precision{ 6 };//count of decimal digits in price data. Used for exporting data
@@ -70,7 +77,7 @@ namespace t18 {
 		//__tickerId is never passed by user. it's defined by framework
 		tickerBase(TickerId __tickerId, const char* name, real_t minPriceD) : m_Name(name), m_tickerId(__tickerId)
 			, m_lastSeenQuote(mxTimestamp(tag_mxTimestamp()), ::std::numeric_limits<real_t>::epsilon())
-			, m_minPriceDelta(minPriceD)
+			, m_minPriceDelta(minPriceD), m_priceTicks(minPriceD)
 		{
 			if (!name) {
 				T18_ASSERT(!"name must be set!");
@@ -123,6 +130,14 @@ namespace t18 {
 			m_bestAsk = ::std::forward<TA>(ask);
 		}
 
+		//puts back the best bid/ask got earlier by getBestBid()/getBestAsk() bypassing the checks of setBestBidAsk(), so
+		// they may be older than the current ones or not set at all. It's for the owner of the market that lets many
+		// trading interfaces make their own guesses of the best bid/ask (see exec::multiBacktester)
+		void _restoreBestBidAsk(const bestPriceInfo_t& bid, const bestPriceInfo_t& ask)noexcept {
+			m_bestBid = bid;
+			m_bestAsk = ask;
+		}
+
 		bool notFilledYet()const noexcept { return getBestBid().TS().empty()/* || getBestAsk().TS().empty()*/; }
 		bool seenAtLeastOneQuote()const noexcept { return !notFilledYet(); }
 
@@ -138,6 +153,15 @@ namespace t18 {
 			return m_minPriceDelta;
 		}
 
+		const priceTicks& getPriceTicks()const noexcept { return m_priceTicks; }
+		//off-grid prices are rounded to the nearest tick, see priceTicks::exactTicks() for a checked conversion
+		price_ticks_t nearestTicks(real_t pr)const noexcept { return m_priceTicks.nearest(pr); }
+		real_t fromTicks(price_ticks_t n)const noexcept { return m_priceTicks.fromTicks(n); }
+		//returns the canonical value of the nearest price on the ticker's price grid
+		real_t snapPrice(real_t pr)const noexcept { return m_priceTicks.snap(pr); }
+		bool snapsPricesToTicks()const noexcept { return m_bSnapPrices; }
+		bool isDataTrusted()const noexcept { return m_bTrustedData; }
+
 		mxTime getEndOfSession()const {
 			if (m_endOfSession.empty()) {
 				T18_ASSERT(!"session time not set!");
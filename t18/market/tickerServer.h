@@ -59,6 +59,12 @@ namespace t18 {
 		bool operator==(const self_t& r)const noexcept { return this == &r; }
 		bool operator!=(const self_t& r)const noexcept { return this != &r; }
 
+		::utils::memFootprint memoryFootprint()const {
+			auto r = base_class_t::memoryFootprint();
+			r.bytes += sizeof(self_t) - sizeof(base_class_t);
+			return r;
+		}
+
 	public:
 
 		void setEndOfSession(mxTime t) {
@@ -89,6 +95,30 @@ namespace t18 {
 			this->m_lotSize = ls;
 		}
 
+		//Opt-in. Snaps prices of every incoming quote, tick or bar to the price grid defined by minPriceDelta. This removes
+		//decimal parsing noise from the data, so the same price always has the same value. Note that prices are still
+		//stored and compared as real_t: stoploss, takeprofit and stop order levels are snapped the same way before
+		//comparisons with them (see exec::priceLevels::cmpLvl()), other comparisons are as exact as their operands are.
+		//Integer numbers of ticks are available on demand only (see priceTicks and getPriceTicks())
+		void snapPricesToTicks(bool b = true)noexcept { this->m_bSnapPrices = b; }
+
+		//Opt-in. Tells the ticker and its timeframes that the incoming data has already been verified (see
+		//feeder::dataCertificate), so per record checks of timestamps ordering and of the data validity are skipped.
+		//Feeding invalid or unordered data then leads to undefined results.
+		void trustData(bool b = true)noexcept {
+			this->m_bTrustedData = b;
+			forEachTF([b](auto& tf)noexcept {
+				tf.trustData(b);
+			});
+		}
+
+		//Opt-in. Keeps the last nDeals deals with their numbers and aggressor sides (see timeseries::dealsStor, getDeals()).
+		//Only the data fed as tsDeal records is stored, plain tsTick-s don't have these attributes.
+		void enableDealsHistory(size_t nDeals) {
+			T18_ASSERT(nDeals > 0);
+			this->m_pDeals = ::std::make_unique<timeseries::dealsStor>(nDeals);
+		}
+
 	private:
 		template<bool b = isBacktesting, typename = ::std::enable_if_t<b>>
 		void _setBestGuessBidAsk(const tsq_data& tso)noexcept {
@@ -130,7 +160,7 @@ namespace t18 {
 		}
 
 		void _newBarOpen_pre(mxTimestamp ts)noexcept {
-			if (UNLIKELY(getLastSeenTS() >= ts)) {//must be non strict here
+			if (!this->m_bTrustedData && UNLIKELY(getLastSeenTS() >= ts)) {//must be non strict here
 				if constexpr(isBacktesting) {
 					T18_ASSERT(!"Got timestamp from the past at _newBarOpen_pre!");
 					T18_COMP_SILENCE_THROWING_NOEXCEPT;
@@ -149,8 +179,16 @@ namespace t18 {
 
 		// #todo must use some type, taken from the bar_t:: here.
 		void _newBarOpen(const tsq_data& tso) noexcept {
+			if (UNLIKELY(this->m_bSnapPrices)) {
+				tsq_data d(tso);
+				this->m_priceTicks.snap(d);
+				_doNewBarOpen(d);
+			} else _doNewBarOpen(tso);
+		}
+	protected:
+		void _doNewBarOpen(const tsq_data& tso) noexcept {
 			//updating last quote and forwarding
-			if (UNLIKELY(getLastSeenTS() >= tso.TS())) {//must be non strict to catch bar open with same time
+			if (!this->m_bTrustedData && UNLIKELY(getLastSeenTS() >= tso.TS())) {//must be non strict to catch bar open with same time
 				if constexpr(isBacktesting) {
 					T18_ASSERT(!"Got timestamp from the past at _newBarOpen!");
 					T18_COMP_SILENCE_THROWING_NOEXCEPT;
@@ -171,6 +209,7 @@ namespace t18 {
 				tf._newBarOpen(tso);
 			});
 		}
+	public:
 		void _newBarOpen_post() noexcept {
 			forEachTF([](auto& tf) noexcept {
 				tf._newBarOpen_post();
@@ -201,8 +240,16 @@ namespace t18 {
 		}*/
 
 		void _newBarAggregate(const bar_t& bar)noexcept {
+			if (UNLIKELY(this->m_bSnapPrices)) {
+				bar_t b(bar);
+				this->m_priceTicks.snap(b);
+				_doNewBarAggregate(b);
+			} else _doNewBarAggregate(bar);
+		}
+	protected:
+		void _doNewBarAggregate(const bar_t& bar)noexcept {
 			//updating last quote and forwarding
-			if (UNLIKELY(getLastSeenTS() > bar.TS())) { //must be strict, as bars with same DT is ok here
+			if (!this->m_bTrustedData && UNLIKELY(getLastSeenTS() > bar.TS())) { //must be strict, as bars with same DT is ok here
 				if constexpr(isBacktesting) {
 					T18_ASSERT(!"Got timestamp from the past at newBarAggregate!");
 					T18_COMP_SILENCE_THROWING_NOEXCEPT;
@@ -224,11 +271,12 @@ namespace t18 {
 				tf._newBarAggregate(bar);
 			});
 		}
+	public:
 
 		//////////////////////////////////////////////////////////////////////////
 
 		void _newTick_pre(mxTimestamp ts)noexcept {
-			if (UNLIKELY(getLastSeenTS() > ts)) {//must be strict here, as ticks with the same time are normal
+			if (!this->m_bTrustedData && UNLIKELY(getLastSeenTS() > ts)) {//must be strict here, as ticks with the same time are normal
 				if constexpr(isBacktesting) {
 					T18_ASSERT(!"Got timestamp from the past at _newTick_pre!");
 					T18_COMP_SILENCE_THROWING_NOEXCEPT;
@@ -245,8 +293,24 @@ namespace t18 {
 			});
 		}
 		void _newTick(const tsTick& tst)noexcept {
+			_newTickOf(tst, nullptr);
+		}
+		//the deal attributes are stored only if the deals history is enabled, otherwise it's the same as a plain tick
+		void _newTick(const tsDeal& d)noexcept {
+			_newTickOf(d, this->m_pDeals ? &d : nullptr);
+		}
+	protected:
+		void _newTickOf(const tsTick& tst, const tsDeal* pDeal)noexcept {
+			if (UNLIKELY(this->m_bSnapPrices)) {
+				tsTick t(tst);
+				this->m_priceTicks.snap(t);
+				_doNewTick(t, pDeal);
+			} else _doNewTick(tst, pDeal);
+		}
+
+		void _doNewTick(const tsTick& tst, const tsDeal* pDeal)noexcept {
 			//updating last quote and forwarding
-			if (UNLIKELY(getLastSeenTS() > tst.TS())) {//must be strict as ticks with same time entirely normal
+			if (!this->m_bTrustedData && UNLIKELY(getLastSeenTS() > tst.TS())) {//must be strict as ticks with same time entirely normal
 				if constexpr(isBacktesting) {
 					T18_ASSERT(!"Got timestamp from the past at _newTick!");
 					T18_COMP_SILENCE_THROWING_NOEXCEPT;
@@ -259,6 +323,9 @@ namespace t18 {
 				}
 			}
 
+			//the price might have been snapped, so it's taken from tst
+			if (pDeal) this->m_pDeals->_store(tsDeal(tst.TS(), tst.q, tst.v, pDeal->bLong, pDeal->dealNum));
+
 			const auto& tso = tst.TSQ();
 			base_class_updh_t::_onNewBarOpen( tso );//essentially onNewTick(), as tick's volume doesn't contain any necessary info
 			// for ticker subscribers
@@ -269,11 +336,58 @@ namespace t18 {
 				tf._newTick(tst);
 			});
 		}
+	public:
 		void _newTick_post() noexcept {
 			forEachTF([](auto& tf) noexcept {
 				tf._newTick_post();
 			});
 		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Rolls back every timeframe to drop bars that might contain data at or after the from timestamp (see
+		// Timeframe::rewindTo()) and restores the last seen quote from the remaining data. The deals history (see
+		// enableDealsHistory()) is dropped entirely, it's refilled by the data fed again.
+		// As bars of higher timeframes have to be rebuilt entirely, the data must be fed again starting from the returned
+		// timestamp, which is the start of the earliest affected bar of all timeframes.
+		mxTimestamp _rewind(mxTimestamp from) {
+			forEachTF([&from](const auto& tf) {
+				TimestampTFMinutes bndry(tf.TF());
+				from = ::std::min(from, mxTimestamp(bndry.adjust(from)));
+			});
+
+			tsq_data lq(mxTimestamp(tag_mxTimestamp()), ::std::numeric_limits<real_t>::epsilon());
+			bool bHaveData = false;
+			forEachTF([from, &lq, &bHaveData](auto& tf) {
+				tf.rewindTo(from);
+				if (tf.size() && tf.lastTimestamp() > lq.TS()) {
+					lq = tsq_data(tf.lastTimestamp(), tf.lastClose());
+					bHaveData = true;
+				}
+			});
+			this->m_lastSeenQuote = lq;
+			if (this->m_pDeals) this->m_pDeals->_clear();
+
+			if constexpr(isBacktesting) {
+				this->m_bestBid = typename base_class_t::bestPriceInfo_t();
+				this->m_bestAsk = typename base_class_t::bestPriceInfo_t();
+				if (bHaveData) _setBestGuessBidAsk(lq);
+			}
+			return from;
+		}
+
+		// Drops all the data (bars of every timeframe, deals and quotes) and returns the ticker to the state it had right
+		// after its setup. Timeframes, settings and the allocated storage are kept. Callbacks registered on the ticker
+		// and on its timeframes aren't notified and are expected to be deregistered already.
+		void _reset() noexcept {
+			forEachTF([](auto& tf)noexcept {
+				tf._reset();
+			});
+			if (this->m_pDeals) this->m_pDeals->_clear();
+
+			this->m_lastSeenQuote = tsq_data(mxTimestamp(tag_mxTimestamp()), ::std::numeric_limits<real_t>::epsilon());
+			this->m_bestBid = typename base_class_t::bestPriceInfo_t();
+			this->m_bestAsk = typename base_class_t::bestPriceInfo_t();
+		}
 	};
 
 }
@@ -48,7 +48,6 @@ namespace t18 { namespace tfConverter {
 		using base_class_t::m_tfBndry;
 
 	protected:
-		using base_class_t::lastBarClosed;
 		using base_class_t::_verifyLastBarClosed;
 		using base_class_t::_verifyLastBarOpened;
 		//using base_class_t::lastBarJustOpened;
@@ -65,6 +64,7 @@ namespace t18 { namespace tfConverter {
 
 	public:
 		using base_class_t::tf;
+		using base_class_t::lastBarClosed;
 
 	public:
 		dailyhm(int dest) : base_class_t(dest) {}
@@ -83,6 +83,21 @@ namespace t18 {
 
 			int tf()const { return m_tfBndry.tf(); }
 
+			//restores the state as if the pLastBar were the last closed bar, or as if there were no bars at all if pLastBar
+			// is null. Used to rewind the timeframe history
+			void rewind(const bar_t* pLastBar) {
+				if (pLastBar) {
+					T18_ASSERT(pLastBar->valid());
+					m_lastBar = *pLastBar;
+					//the bar timestamp is already adjusted to the period start, we need just to restore the upper boundary
+					m_tfBndry.adjust(m_lastBar.TS());
+				} else {
+					m_lastBar = bar_t(typename bar_t::tag_Default_t());
+					m_tfBndry = TimestampTFMinutes(m_tfBndry.tf());
+				}
+				_setLastBarClosed_clearBarHasData();
+			}
+
 		protected:
 			void _doClose() {
 				_verifyFlagSet_BarHasData();
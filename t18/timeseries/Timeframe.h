@@ -20,9 +20,9 @@
 #include "timeframeStor.h"
 #include "../tfConverter/tfConvBase.h"
 
-//#TODO: some terminals might "redraw" some amount of previous bars due to network latency problems or something else.
-//To deal with it, we probably should provide an API to reset and recalculate some amount of already stored data!?
-//#TODO or at least to detect such events!
+//Some terminals might "redraw" some amount of previous bars due to network latency problems or something else.
+//Use rewind()/rewindTo() to drop the affected bars and then feed the corrected data.
+//#TODO detect such events!
 
 namespace t18 {
 
@@ -62,6 +62,34 @@ namespace t18 {
 			//int BaseTF()const noexcept { return m_tfConv.baseTf(); }
 			bool lastBarJustClosed()const noexcept { return m_tfConv.lastBarClosed(); }
 			//bool lastBarJustOpened()const noexcept { return m_tfConv.lastBarJustOpened(); }
+
+			::utils::memFootprint memoryFootprint(const char* name = "timeframe")const {
+				auto r = base_class_t::memoryFootprint(name);
+				r.bytes += sizeof(Timeframe) - sizeof(base_class_t);
+				return r;
+			}
+
+			//drops nBars newest bars (including the current bar even if it's still aggregating). After that the
+			// timeframe looks like the bar nBars of the prior state was the last closed bar, so the corrected data could be fed
+			// right after it. onRewind() subscribers are notified to roll back their data.
+			// Only bars that are still in the storage (not in the archive) could be rewound
+			void rewind(size_t nBars) {
+				base_class_t::_rewind(nBars, m_tfConv);
+			}
+
+			//drops all bars that might contain data with timestamps at or after from. Returns the count of bars dropped
+			size_t rewindTo(mxTimestamp from) {
+				TimestampTFMinutes bndry(TF());
+				const auto N = base_class_t::lowerBound(bndry.adjust(from));
+				const size_t nBars = N < base_class_t::size() ? N + 1 : 0;
+				rewind(nBars);
+				return nBars;
+			}
+
+			//see timeframeStor::_reset()
+			void _reset() noexcept {
+				base_class_t::_reset(m_tfConv);
+			}
 			
 		public:
 			// #todo hide this (updating) interface from trade system code.
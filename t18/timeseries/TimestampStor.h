@@ -21,6 +21,8 @@
 #include <boost/type_traits/is_assignable.hpp>
 #include <boost/circular_buffer.hpp>
 
+#include <algorithm>
+
 #include "../base.h"
 #include "TsStor.h"
 #include "../date_time.h"
@@ -38,6 +40,15 @@ namespace t18 { namespace timeseries {
 		
 		static_assert(hana::any_of(hana::keys(HanaMapT()), utils::is_hana_string<timestamp_ht>), "There must be a key for timestamp");
 
+	protected:
+		//optional per-day index: holds a date and an absolute number (see BarIndex()) of the first bar of the date.
+		// Newest day is at index 0. Disabled (zero capacity) by default, see enableDayIndex()
+		struct dayFirstBar_t {
+			mxDate d;
+			size_t firstBar;
+		};
+		TsCont_t<dayFirstBar_t> m_dayIdx;
+
 	public:
 		TimestampStor(size_t N) : base_class_t(N) {}
 
@@ -64,6 +75,131 @@ namespace t18 { namespace timeseries {
 		auto time(size_t N)const { return  timestamp(N).Time(); }
 		auto lastDate()const { return date(0); }
 		auto lastTime()const { return time(0); }*/
+
+		//////////////////////////////////////////////////////////////////////////
+		// time-indexed lookup. Timestamps are stored in a non-increasing order (the newest bar is at index 0), so all
+		// functions below perform a binary search over the ts column and return a "bars ago" index N suitable for
+		// get()/timestamp() and so on, or size() if there's no such bar in the storage.
+
+		//returns the index of the newest bar with timestamp <= ts, i.e. the bar that was open at the moment ts.
+		size_t barAt(mxTimestamp ts)const noexcept { return _barAt(ts, 0, size()); }
+
+		//returns the index of the oldest bar with timestamp >= ts (the same as ::std::lower_bound() does in chronological order)
+		size_t lowerBound(mxTimestamp ts)const noexcept {
+			const auto& c = base_class_t::template getTs<timestamp_ht>();
+			const size_t n = static_cast<size_t>(::std::partition_point(c.begin(), c.end()
+				, [ts](const mxTimestamp& v)noexcept { return v >= ts; }) - c.begin());
+			return n ? n - 1 : size();
+		}
+
+		//returns the index of the bar with exactly the same timestamp (the newest one, if there're many)
+		size_t indexOf(mxTimestamp ts)const noexcept {
+			const auto N = barAt(ts);
+			return (N < size() && timestamp(N) == ts) ? N : size();
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// per-day index is just a shortcut to narrow binary search to a single day bars. Might be beneficial for
+		// intraday timeframes with a long history. It remembers up to nDays last days and starts to work from the next
+		// stored bar, so it's better to enable it right after the construction.
+		void enableDayIndex(size_t nDays) {
+			T18_ASSERT(nDays > 0);
+			m_dayIdx.set_capacity(nDays);
+		}
+		bool hasDayIndex()const noexcept { return m_dayIdx.capacity() > 0; }
+
+		//returns the index of the first (stored) bar of the day d, or size() if the storage doesn't have such bars
+		size_t dayFirstBar(mxDate d)const noexcept {
+			size_t first, last;
+			if (_dayRange(d, first, last)) return first < last ? last - 1 : size();
+
+			const auto N = lowerBound(mxTimestamp(d, mxTime(tag_mxTime())));
+			return (N < size() && timestamp(N).Date() == d) ? N : size();
+		}
+
+		//the same as barAt(mxTimestamp(d,t)), however uses the day index to narrow the search if it's available.
+		// Returns size() if there's no bar at the day d that was open at the moment t
+		size_t barAt(mxDate d, mxTime t)const noexcept {
+			const auto ts = mxTimestamp(d, t);
+			size_t first, last;
+			if (_dayRange(d, first, last)) {
+				const auto N = _barAt(ts, first, last);
+				return N < last ? N : size();
+			}
+			const auto N = barAt(ts);
+			return (N < size() && timestamp(N).Date() == d) ? N : size();
+		}
+
+		::utils::memFootprint memoryFootprint(const char* name = "TimestampStor")const {
+			auto r = base_class_t::memoryFootprint(name);
+			r.bytes += sizeof(TimestampStor) - sizeof(base_class_t);
+			if (hasDayIndex()) r.add("dayIndex", ::utils::heapBytes(m_dayIdx));
+			return r;
+		}
+
+	protected:
+		//hides TsStor::storeBar() to maintain the day index
+		void storeBar(typename base_class_t::TsData_ht&& v) noexcept {
+			if (hasDayIndex()) _updateDayIndex(v[timestamp_ht()]);
+			base_class_t::storeBar(::std::move(v));
+		}
+		void storeBar(const typename base_class_t::TsData_ht& v) noexcept {
+			if (hasDayIndex()) _updateDayIndex(v[timestamp_ht()]);
+			base_class_t::storeBar(v);
+		}
+
+		void dropLastBars(size_t N) noexcept {
+			base_class_t::dropLastBars(N);
+			//days that start in the dropped bars are gone
+			const auto tb = TotalBars();
+			while (m_dayIdx.size() && m_dayIdx[0].firstBar >= tb) m_dayIdx.pop_front();
+		}
+
+		void clear() noexcept {
+			base_class_t::clear();
+			m_dayIdx.clear();
+		}
+
+	private:
+		void _updateDayIndex(const mxTimestamp& ts) noexcept {
+			const auto d = ts.Date();
+			if (m_dayIdx.empty() || m_dayIdx.front().d != d) {
+				T18_ASSERT(m_dayIdx.empty() || m_dayIdx.front().d < d);
+				m_dayIdx.push_front(dayFirstBar_t{ d, TotalBars() });
+			}
+		}
+
+		//converts an absolute bar number to the index. Returns size() if the bar has already been pushed out of the storage
+		size_t _absToIndex(size_t absBar)const noexcept {
+			return absBar + size() < TotalBars() ? size() : BarIndex(absBar);
+		}
+
+		//finds [first, last) range of indexes of the day d bars using the day index. Returns false if the day index
+		// can't help. Empty range means there're no such bars
+		bool _dayRange(mxDate d, size_t& first, size_t& last)const noexcept {
+			if (!hasDayIndex()) return false;
+			//the newest entry with date <= d
+			const auto it = ::std::partition_point(m_dayIdx.begin(), m_dayIdx.end()
+				, [d](const dayFirstBar_t& e)noexcept { return e.d > d; });
+			//the day might be older than the day index holds
+			if (it == m_dayIdx.end()) return false;
+			if (it->d != d) {
+				first = last = 0;
+				return true;
+			}
+			first = it == m_dayIdx.begin() ? 0 : _absToIndex((it - 1)->firstBar) + 1;
+			last = ::std::min(_absToIndex(it->firstBar) + 1, size());
+			if (first > last) first = last;
+			return true;
+		}
+
+		//searches [first, last) range of indexes. Returns last if not found
+		size_t _barAt(mxTimestamp ts, size_t first, size_t last)const noexcept {
+			T18_ASSERT(first <= last && last <= size());
+			const auto& c = base_class_t::template getTs<timestamp_ht>();
+			return static_cast<size_t>(::std::partition_point(c.begin() + first, c.begin() + last
+				, [ts](const mxTimestamp& v)noexcept { return v > ts; }) - c.begin());
+		}
 	};
 
 }}
@@ -94,6 +94,23 @@ namespace timeseries {
 		}
 
 
+		//removes N newest bars, so the bar N becomes the last one
+		void dropLastBars(size_t N) noexcept {
+			T18_ASSERT(N <= size());
+			hana::for_each(m_ContMap, [N](auto& x)noexcept {
+				hana::second(x).erase_begin(N);
+			});
+			m_TotalBars -= N;
+		}
+
+		//removes all bars, the storage remains allocated
+		void clear() noexcept {
+			hana::for_each(m_ContMap, [](auto& x)noexcept {
+				hana::second(x).clear();
+			});
+			m_TotalBars = 0;
+		}
+
 		void updateLastBar(TsData_ht&& v) noexcept {
 			auto& contMap = m_ContMap;
 			hana::for_each(v, [&contMap](auto&& x)noexcept {
@@ -134,6 +151,15 @@ namespace timeseries {
 
 		template<typename HStrT, typename = ::std::enable_if_t<hana::is_a<hana::string_tag, HStrT>>>
 		const auto& getTs(HStrT)const noexcept { return getTs<HStrT>(); }
+
+		//each column is reported as a child node named by its key
+		::utils::memFootprint memoryFootprint(const char* name = "TsStor")const {
+			::utils::memFootprint r(name, sizeof(self_t));
+			hana::for_each(m_ContMap, [&r](const auto& x) {
+				r.add(hana::first(x).c_str(), ::utils::heapBytes(hana::second(x)));
+			});
+			return r;
+		}
 	};
 
 
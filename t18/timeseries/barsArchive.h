@@ -0,0 +1,232 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <new>
+
+#include "../base.h"
+#include "../utils/varint.h"
+
+namespace t18 { namespace timeseries {
+
+	//barsArchive is a compressed append-only storage of tsohlcv bars. It's intended to be a "cold tier" for
+	// a timeframe history, that has already been pushed out of the TsStor ring buffer (see timeframeStor::enableArchive())
+	// Bars are grouped into blocks of m_blockSize bars and each block is encoded independently, so an access to a random
+	// bar costs at max m_blockSize bars decoding.
+	// - timestamps are delta-of-delta encoded (using raw mxTimestamp values, so a regular timeframe step results mostly in 0)
+	// - prices are converted to a number of price steps (minPriceDelta of a ticker) and stored as zigzag varints:
+	//		open against the previous close, high/low/close against the open
+	// - volume is stored as a varint number of volume steps
+	// Values that aren't on the grid of steps are rounded to the nearest step, see offGridCount().
+	// When 1/step is an integer (0.01, 0.5 and so on), values are restored as (number of steps)/(1/step), which gives
+	// exactly the same double as parsing of a decimal string does. Otherwise they are restored as (number of steps)*step
+	// and may differ from the original values by a floating point rounding error.
+	// push_back() never throws, because it's called while the data is being fed, see allocFailed().
+	class barsArchive {
+	public:
+		typedef tsohlcv bar_t;
+		static constexpr size_t defaultBlockSize = 256;
+		//the longest encoding of a bar: 6 varints
+		static constexpr size_t maxBarBytes = 6 * utils::varint::maxBytes;
+
+	protected:
+		struct codecState {
+			timestamp_ult ts = 0;
+			::std::int64_t tsDelta = 0;
+			::std::int64_t c = 0;
+		};
+
+		//converts volumes to a number of volume steps and back
+		struct volSteps {
+			volume_t step;
+
+			volSteps(volume_t s)noexcept : step(s) {}
+
+			::std::int64_t nearest(volume_t v, bool& bOnGrid)const noexcept {
+				const volume_t r = v / step;
+				const auto n = ::std::llround(r);
+				bOnGrid = ::std::abs(r - static_cast<volume_t>(n)) <= volume_t(1e-3);
+				return n;
+			}
+			volume_t fromTicks(::std::int64_t n)const noexcept { return static_cast<volume_t>(n) * step; }
+		};
+
+	protected:
+		::std::vector<::std::uint8_t> m_data;
+		::std::vector<size_t> m_blocks;//offsets of blocks in m_data
+
+		codecState m_state;//state of the encoder
+
+		const priceTicks m_price;
+		const volSteps m_vol;
+		const size_t m_blockSize;
+		size_t m_firstBarNum;//absolute number of the first archived bar (see TsStor::BarIndex())
+		size_t m_size = 0;
+		size_t m_offGrid = 0;
+		bool m_bAllocFailed = false;
+
+	protected:
+		//makes sure that the next bar fits into the allocated memory, so encoding never reallocates
+		bool _reserveNext()noexcept {
+			try {
+				if (m_data.capacity() - m_data.size() < maxBarBytes) {
+					m_data.reserve(::std::max(m_data.size() + maxBarBytes, 2 * m_data.capacity()));
+				}
+				if (0 == m_size % m_blockSize && m_blocks.size() == m_blocks.capacity()) {
+					m_blocks.reserve(::std::max(size_t(8), 2 * m_blocks.capacity()));
+				}
+			} catch (const ::std::bad_alloc&) {
+				return false;
+			}
+			return true;
+		}
+
+	public:
+		barsArchive(real_t priceStep, volume_t volStep = volume_t(1), size_t firstBarNum = 0, size_t blockSize = defaultBlockSize)
+			: m_price(priceStep), m_vol(volStep), m_blockSize(blockSize), m_firstBarNum(firstBarNum)
+		{
+			if (UNLIKELY(!(priceStep > 0) || !(volStep > 0) || blockSize < 1)) {
+				T18_ASSERT(!"Invalid barsArchive parameters");
+				throw ::std::logic_error("Invalid barsArchive parameters");
+			}
+		}
+
+		size_t size()const noexcept { return m_size; }
+		bool empty()const noexcept { return 0 == m_size; }
+		size_t firstBarNum()const noexcept { return m_firstBarNum; }
+		real_t priceStep()const noexcept { return m_price.step; }
+		volume_t volStep()const noexcept { return m_vol.step; }
+		//count of archived values, that weren't on the grid of steps and were rounded. Non zero value means
+		// that the price or volume step passed to the constructor doesn't suit the data
+		size_t offGridCount()const noexcept { return m_offGrid; }
+		//set if the archive failed to allocate memory for a bar. Bars aren't accepted since then, as the archived history
+		// must be contiguous, so the bars that are pushed out of a timeframe afterwards are lost
+		bool allocFailed()const noexcept { return m_bAllocFailed; }
+
+		//memory used by the archive
+		size_t bytes()const noexcept {
+			return sizeof(*this) + m_data.capacity() * sizeof(decltype(m_data)::value_type)
+				+ m_blocks.capacity() * sizeof(decltype(m_blocks)::value_type);
+		}
+		void shrink_to_fit() {
+			m_data.shrink_to_fit();
+			m_blocks.shrink_to_fit();
+		}
+
+		//drops all bars keeping the allocated memory, the next pushed bar gets the number firstBarNum
+		void clear(size_t firstBarNum = 0)noexcept {
+			m_data.clear();
+			m_blocks.clear();
+			m_state = codecState();
+			m_firstBarNum = firstBarNum;
+			m_size = 0;
+			m_offGrid = 0;
+			m_bAllocFailed = false;
+		}
+
+		//appends the bar, returns false if there's no memory for it (see allocFailed())
+		bool push_back(const bar_t& b)noexcept {
+			if (UNLIKELY(m_bAllocFailed || !_reserveNext())) {
+				m_bAllocFailed = true;
+				return false;
+			}
+
+			const auto o = _toSteps(m_price, b.o());
+			const auto h = _toSteps(m_price, b.h);
+			const auto l = _toSteps(m_price, b.l);
+			const auto c = _toSteps(m_price, b.c);
+			const auto v = _toSteps(m_vol, b.v);
+			T18_ASSERT(v >= 0);
+
+			if (0 == m_size % m_blockSize) {
+				m_blocks.push_back(m_data.size());
+				m_state = codecState();
+			}
+
+			const auto ts = b.TS()._get();
+			const auto tsDelta = static_cast<::std::int64_t>(ts - m_state.ts);
+			utils::varint::put_signed(m_data, tsDelta - m_state.tsDelta);
+			utils::varint::put_signed(m_data, o - m_state.c);
+			utils::varint::put_signed(m_data, h - o);
+			utils::varint::put_signed(m_data, o - l);
+			utils::varint::put_signed(m_data, c - o);
+			utils::varint::put(m_data, static_cast<::std::uint64_t>(v));
+
+			m_state.ts = ts;
+			m_state.tsDelta = tsDelta;
+			m_state.c = c;
+			++m_size;
+			return true;
+		}
+
+		//i is an index in the archive, 0 is the oldest bar
+		bar_t bar(size_t i)const noexcept {
+			T18_ASSERT(i < m_size);
+			bar_t b;
+			forEach(i, i + 1, [&b](const bar_t& x)noexcept { b = x; });
+			return b;
+		}
+
+		//sequentially decodes bars [from, to) and passes them to f
+		template<typename F>
+		void forEach(size_t from, size_t to, F&& f)const {
+			T18_ASSERT(from <= to && to <= m_size);
+			if (from >= to) return;
+
+			size_t blk = from / m_blockSize, i = blk * m_blockSize;
+			while (i < to) {
+				const ::std::uint8_t* p = m_data.data() + m_blocks[blk];
+				codecState st;
+				const size_t blkEnd = ::std::min(i + m_blockSize, to);
+				for (; i < blkEnd; ++i) {
+					const auto b = _decode(p, st);
+					if (i >= from) ::std::forward<F>(f)(b);
+				}
+				++blk;
+			}
+		}
+		template<typename F>
+		void forEach(F&& f)const { forEach(0, m_size, ::std::forward<F>(f)); }
+
+	protected:
+		template<typename StepsT, typename T>
+		::std::int64_t _toSteps(const StepsT& pt, T v)noexcept {
+			bool bOnGrid;
+			const auto n = pt.nearest(v, bOnGrid);
+			if (UNLIKELY(!bOnGrid)) ++m_offGrid;
+			return n;
+		}
+
+		bar_t _decode(const ::std::uint8_t*& p, codecState& st)const noexcept {
+			st.tsDelta += utils::varint::get_signed(p);
+			st.ts += static_cast<timestamp_ult>(st.tsDelta);
+			const auto o = st.c + utils::varint::get_signed(p);
+			const auto h = o + utils::varint::get_signed(p);
+			const auto l = o - utils::varint::get_signed(p);
+			const auto c = o + utils::varint::get_signed(p);
+			const auto v = utils::varint::get(p);
+			st.c = c;
+			return bar_t(mxTimestamp(st.ts), m_price.fromTicks(o), m_price.fromTicks(h), m_price.fromTicks(l), m_price.fromTicks(c)
+				, m_vol.fromTicks(static_cast<::std::int64_t>(v)));
+		}
+	};
+
+} }
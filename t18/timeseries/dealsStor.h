@@ -0,0 +1,74 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "TimestampStor.h"
+
+namespace t18 { namespace timeseries {
+
+	//dealsStor keeps the last deals of a ticker with all their attributes (see tsDeal): the deal number and the aggressor
+	// side in addition to the price and the volume. It's an optional storage, that is filled only if a ticker has it enabled
+	// (see tickerServer::enableDealsHistory()) and is fed with tsDeal records (for example, by feeder::adapters::csv_tsDeal).
+	// The newest deal has the index 0
+	class dealsStor : public TimestampStor<tsDeal::metaDescr_t> {
+	private:
+		typedef TimestampStor<tsDeal::metaDescr_t> base_class_t;
+
+	public:
+		dealsStor(size_t N) : base_class_t(N) {}
+
+		using base_class_t::size;
+		using base_class_t::capacity;
+		using base_class_t::TotalBars;
+		using base_class_t::BarIndex;
+		using base_class_t::timestamp;
+		using base_class_t::lastTimestamp;
+		using base_class_t::get;
+		using base_class_t::barAt;
+		using base_class_t::lowerBound;
+
+		auto price(size_t N)const noexcept { return get(quote_ht(), N); }
+		auto vol(size_t N)const noexcept { return get(volume_ht(), N); }
+		auto dealNum(size_t N)const noexcept { return get(dealnum_ht(), N); }
+		bool isLong(size_t N)const noexcept { return get(bLong_ht(), N); }
+
+		tsDeal deal(size_t N)const noexcept {
+			return tsDeal(timestamp(N), price(N), vol(N), isLong(N), dealNum(N));
+		}
+		tsDeal lastDeal()const noexcept { return deal(0); }
+
+		//deal numbers of an exchange are increasing, so a deal with a number that isn't greater than the number of the
+		// last stored deal has already been seen. Helps to drop duplicates when the data is reloaded
+		bool isSeen(dealnum_t dn)const noexcept { return size() > 0 && dn <= dealNum(0); }
+
+		::utils::memFootprint memoryFootprint(const char* name = "deals")const {
+			auto r = base_class_t::memoryFootprint(name);
+			r.bytes += sizeof(dealsStor) - sizeof(base_class_t);
+			return r;
+		}
+
+		// #todo hide this (updating) interface from trade system code.
+		void _store(const tsDeal& d) noexcept {
+			base_class_t::storeBar(d.to_hmap());
+		}
+		void _clear() noexcept {
+			base_class_t::clear();
+		}
+	};
+
+} }
@@ -19,6 +19,7 @@
 
 #include "updatesHandler.h"
 #include "TimestampStor.h"
+#include "barsArchive.h"
 #include "../tfConverter/tfConvBase.h"
 #include "../timefilter.h"
 
@@ -82,6 +83,11 @@ namespace t18 { namespace timeseries {
 
 		T18_DEBUG_ONLY(mxTimestamp m_lastTimeFilterTime);
 		bool m_lastTimeFilterReject = false;
+		//skips per record data checks, see trustData()
+		bool m_bTrustedData = false;
+
+		//optional compressed storage for bars pushed out of the ring, see enableArchive()
+		::std::unique_ptr<barsArchive> m_pArchive;
 
 		//bool m_curBarJustClosed = false;
 
@@ -99,7 +105,15 @@ namespace t18 { namespace timeseries {
 		}
 		const auto& getTimeFilter()const noexcept { return m_timeFltr; }
 
+		//the data fed is known to be valid and ordered (usually set by tickerServer::trustData())
+		void trustData(bool b = true)noexcept { m_bTrustedData = b; }
+		bool isDataTrusted()const noexcept { return m_bTrustedData; }
+
 		///////////////////////////////////////////////////////////////////
+		using base_class_t::size;
+		using base_class_t::capacity;
+		using base_class_t::TotalBars;
+		using base_class_t::BarIndex;
 		using base_class_t::timestamp;
 		using base_class_t::lastTimestamp;
 		using base_class_t::get;
@@ -132,12 +146,62 @@ namespace t18 { namespace timeseries {
 		}
 
 		bar_t lastBar() const noexcept { return bar(0); }
+
+		//////////////////////////////////////////////////////////////////////////
+		// Compressed "cold tier" of the history. When enabled, each bar that is about to be pushed out of the ring
+		// is appended to the barsArchive, so the whole history (except for bars that were lost before the call)
+		// remains available via barByNum(). priceStep is usually a ticker's minPriceDelta
+		void enableArchive(real_t priceStep, volume_t volStep = volume_t(1), size_t blockSize = barsArchive::defaultBlockSize) {
+			static_assert(::std::is_same_v<bar_t, tsohlcv>, "Not implemented yet");
+			if (UNLIKELY(m_pArchive)) {
+				T18_ASSERT(!"Archive is already enabled");
+				throw ::std::logic_error("Archive is already enabled");
+			}
+			m_pArchive = ::std::make_unique<barsArchive>(priceStep, volStep, TotalBars() - size(), blockSize);
+		}
+		const barsArchive* getArchive()const noexcept { return m_pArchive.get(); }
+
+		//total count of bars available either in the ring or in the archive
+		size_t historySize()const noexcept {
+			return m_pArchive && !m_pArchive->allocFailed() ? TotalBars() - m_pArchive->firstBarNum() : size();
+		}
+
+		//returns a bar by its absolute number (see BarIndex()) from either the ring or the archive
+		tsohlcv barByNum(size_t barNum)const {
+			if (UNLIKELY(barNum >= TotalBars())) {
+				throw ::std::out_of_range("barByNum: there's no bar #" + ::std::to_string(barNum));
+			}
+			if (LIKELY(barNum + size() >= TotalBars())) return bar(BarIndex(barNum));
+			if (UNLIKELY(!m_pArchive || barNum < m_pArchive->firstBarNum()
+				|| barNum - m_pArchive->firstBarNum() >= m_pArchive->size()))
+			{
+				throw ::std::out_of_range("barByNum: bar #" + ::std::to_string(barNum) + " has already been dropped");
+			}
+			return m_pArchive->bar(barNum - m_pArchive->firstBarNum());
+		}
+
+		::utils::memFootprint memoryFootprint(const char* name = "timeframe")const {
+			auto r = base_class_t::memoryFootprint(name);
+			r.bytes += sizeof(timeframeStor) - sizeof(base_class_t);
+			if (m_pArchive) r.add("archive", m_pArchive->bytes());
+			return r;
+		}
 		
 		//////////////////////////////////////////////////////////////////////////
 		//////////////////////////////////////////////////////////////////////////
 		////////////////////////////////////////////////////////////////////////// 
 
 	protected:
+		template<typename HMT>
+		void _storeBar(HMT&& v)noexcept {
+			if (m_pArchive && size() == capacity()) {
+				//the oldest bar is about to be dropped from the ring. Off-grid values are rounded, see barsArchive::offGridCount()
+				// The bar is lost if the archive is out of memory, see barsArchive::allocFailed()
+				m_pArchive->push_back(bar(size() - 1));
+			}
+			base_class_t::storeBar(::std::forward<HMT>(v));
+		}
+
 		void _updateLastBar(updateDataMap_t&& v) noexcept {
 			hana::for_each(v, [&contMap = base_class_t::m_ContMap](auto&& x) noexcept {
 				contMap[hana::first(x)][0] = ::std::move(hana::second(x));
@@ -216,6 +280,45 @@ namespace t18 { namespace timeseries {
 			}
 		}
 
+		template<typename TfConvT>
+		void _rewind(size_t nBars, TfConvT& tfConv) {
+			static_assert(::std::is_same_v<bar_t, tsohlcv>, "Not implemented yet");
+			if (!nBars) return;
+			if (UNLIKELY(nBars > size())) {
+				throw ::std::out_of_range("rewind: can't rewind " + ::std::to_string(nBars) + " bars, only "
+					+ ::std::to_string(size()) + " are stored");
+			}
+			T18_DEBUG_ONLY(_verifyWasClosed());
+
+			//the newest bar might still be aggregating, then it was never reported as closed
+			const size_t nClosed = tfConv.lastBarClosed() ? nBars : nBars - 1;
+
+			base_class_t::dropLastBars(nBars);
+			if (size()) {
+				const auto lb = lastBar();
+				tfConv.rewind(&lb);
+			} else tfConv.rewind(nullptr);
+
+			m_pCurBar = nullptr;
+			T18_DEBUG_ONLY(m_lastTimeFilterTime = size() ? lastTimestamp() : mxTimestamp(1901, 1, 1, 1, 1, 1));
+
+			base_class_updH_t::_onRewind(nBars, nClosed);
+		}
+
+		//drops all bars (including the archived ones) and returns to the state right after the construction keeping
+		// the settings and the allocated storage. Subscribers aren't notified, they are expected to be gone already.
+		template<typename TfConvT>
+		void _reset(TfConvT& tfConv) noexcept {
+			base_class_t::clear();
+			if (m_pArchive) m_pArchive->clear();
+			tfConv.rewind(nullptr);
+
+			m_pCurBar = nullptr;
+			m_lastTimeFilterReject = false;
+			T18_DEBUG_ONLY(m_openCloseState = 0);
+			T18_DEBUG_ONLY(m_lastTimeFilterTime = mxTimestamp(1901, 1, 1, 1, 1, 1));
+		}
+
 		//////////////////////////////////////////////////////////////////////////
 	public:
 		// #todo hide this (updating) interface from trade system code.
@@ -279,7 +382,7 @@ namespace t18 { namespace timeseries {
 			if (m_lastTimeFilterReject) return;
 
 			T18_DEBUG_ONLY(_verifyWasClosed();)
-			_checkTS(ts, "_newBarOpen_pre", false);
+			if (!m_bTrustedData) _checkTS(ts, "_newBarOpen_pre", false);
 
 			//first we must check if the prev bar must have already been completed here
 			// #WARNING ! listening to onBarClose() and acting/trading in a event handler might lead to assertions failure assotiated with
@@ -298,7 +401,7 @@ namespace t18 { namespace timeseries {
 
 			T18_DEBUG_ONLY(_checkTS(tso, "_newBarOpen", false));
 
-			if (UNLIKELY(tso.q <= 0)) {
+			if (!m_bTrustedData && UNLIKELY(tso.q <= 0)) {
 				T18_ASSERT(!"Invalid Open");
 				T18_COMP_SILENCE_THROWING_NOEXCEPT;
 				throw ::std::runtime_error("_newBarOpen: invalid open = "s + tso.to_string());
@@ -313,7 +416,7 @@ namespace t18 { namespace timeseries {
 				T18_DEBUG_ONLY(_checkBar(*m_pCurBar, "_newBarOpen", false, true));
 
 				//inserting new bar into TsCont
-				base_class_t::storeBar(m_pCurBar->to_hmap());
+				_storeBar(m_pCurBar->to_hmap());
 			}
 		}
 
@@ -339,7 +442,7 @@ namespace t18 { namespace timeseries {
 			T18_DEBUG_ONLY(_verifyWasOpenedAndClose();)
 
 			//check for consistence first
-			_checkBar(bar, "_newBarAggregate", true);
+			if (!m_bTrustedData) _checkBar(bar, "_newBarAggregate", true);
 			//#TODO need a better handler for inconsistent data. It should not throw at all!
 
 			m_pCurBar = tfConv.aggregate(bar);
@@ -390,7 +493,7 @@ namespace t18 { namespace timeseries {
 			m_lastTimeFilterReject = m_timeFltr.shouldReject(ts.Time());
 			if (m_lastTimeFilterReject) return;
 
-			_checkTS(ts, "_newTick_pre", true);
+			if (!m_bTrustedData) _checkTS(ts, "_newTick_pre", true);
 			
 			//first we must check if the prev bar must have already been completed here
 			// #WARNING ! listening to onBarClose() and acting/trading in a event handler might lead to assertions failure assotiated with
@@ -406,7 +509,7 @@ namespace t18 { namespace timeseries {
 
 			T18_DEBUG_ONLY(_checkTS(tst, "_newTick", true));
 
-			if (UNLIKELY(tst.invalid())) {
+			if (!m_bTrustedData && UNLIKELY(tst.invalid())) {
 				T18_ASSERT(!"Invalid tick data");
 				T18_COMP_SILENCE_THROWING_NOEXCEPT;
 				throw ::std::runtime_error("_newTick: invalid tick = "s + tst.to_string());
@@ -421,7 +524,7 @@ namespace t18 { namespace timeseries {
 				T18_DEBUG_ONLY(_checkBar(*m_pCurBar, "_newTick", false));
 
 				//inserting new bar into TsCont
-				base_class_t::storeBar(m_pCurBar->to_hmap());
+				_storeBar(m_pCurBar->to_hmap());
 				//leaving m_pCurBar non null to run event callback during _post phase
 			} else {
 				//we must update check-update the cur bar
@@ -107,13 +107,17 @@ namespace t18 {
 		public:
 			using base_class_t::call_wrapper_t;
 			typedef typename call_wrapper_t::template call_tpl<void(const tsohlcv& bar)> onNewBarCloseCB_t;
+			//nBars is the count of bars removed, nClosedBars of them had been reported by onNewBarClose
+			typedef typename call_wrapper_t::template call_tpl<void(size_t nBars, size_t nClosedBars)> onRewindCB_t;
 			
 		private:
 			typedef ::std::list<onNewBarCloseCB_t> onNewBarCloseCBStor_t;
+			typedef ::std::list<onRewindCB_t> onRewindCBStor_t;
 			
 		private:
 			//#TODO refactor all this shit into a single hana::map
 			onNewBarCloseCBStor_t m_onNewBarCloseCBs;
+			onRewindCBStor_t m_onRewindCBs;
 
 		protected:
 			TFUpdatesHandler() noexcept : base_class_t() {}
@@ -123,6 +127,11 @@ namespace t18 {
 					f(bar);
 				}
 			}
+			void _onRewind(size_t nBars, size_t nClosedBars)const {
+				for (const auto& f : m_onRewindCBs) {
+					f(nBars, nClosedBars);
+				}
+			}
 
 		private:
 			//assert triggering here is a sign that this object might have already been destroyed!
@@ -130,6 +139,10 @@ namespace t18 {
 				T18_ASSERT(m_onNewBarCloseCBs.size());
 				m_onNewBarCloseCBs.erase(it);
 			}
+			void _deregister(typename onRewindCBStor_t::iterator it) noexcept {
+				T18_ASSERT(m_onRewindCBs.size());
+				m_onRewindCBs.erase(it);
+			}
 			
 			template<typename CBStorT>
 			auto _makeHandle(CBStorT& stor) {
@@ -158,6 +171,15 @@ namespace t18 {
 			}
 
 			size_t countOfOnNewBarClose()const noexcept { return m_onNewBarCloseCBs.size(); }
+
+			// onRewind() is fired after the timeframe has dropped some of its latest bars (see Timeframe::rewind()).
+			// Subscribers must roll back the data derived from these bars, for example, by calling algs::tAlg::rewind()
+			decltype(auto) registerOnRewind(onRewindCB_t&& f) {
+				m_onRewindCBs.push_back(::std::move(f));
+				return _makeHandle(m_onRewindCBs);
+			}
+
+			size_t countOfOnRewind()const noexcept { return m_onRewindCBs.size(); }
 		};
 
 	}
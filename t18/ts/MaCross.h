@@ -289,8 +289,8 @@ namespace t18 { namespace ts {
 		template<typename ExecT>
 		void setup(ExecT& exe) {
 			//we must define here which tickers and timeframes our TS will use
-			//first decide what are the runtime parameters.
-			maFast = 10;
+			//first decide what are the runtime parameters (unless they were given, for example, by a parameter sweep).
+			if (!maFast) maFast = 10;
 			//ticker name also specifies the ticker csv data file
 			if (pTickerName) {
 				T18_ASSERT(tickerLotSize > 0 && tickerMinPriceDelta > 0);
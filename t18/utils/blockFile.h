@@ -0,0 +1,221 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <memory>
+#include <cstring>
+#include <algorithm>
+
+#include "myFile.h"
+#include "prefetchReader.h"
+#include "decompressor.h"
+
+namespace utils {
+
+	//blockFile is a read-only myFile, that reads the file by large blocks and splits them into lines with memchr.
+	//It's intended to replace per-record stdio calls (like fscanf) on large text files.
+	//The file is always opened in a binary mode, so the lines returned may end with '\r'
+	//If prefetching is on (see setPrefetch()), the blocks are read ahead by a prefetchReader thread.
+	//Files compressed with zstd or lz4 (detected by extension, see decompressor.h) are decompressed on the fly, offsets
+	// are in the decompressed data then. Compressed streams have no random access, so a compressed file could only be
+	// seeked forward (the data in between is decompressed and skipped) or rewound to the beginning. See seek()
+	class blockFile : public myFile {
+	private:
+		typedef myFile base_class_t;
+
+	public:
+		static constexpr size_t defaultBlockSize = 1024 * 1024;
+
+	protected:
+		::std::unique_ptr<char[]> m_buf;
+		size_t m_bufSize = 0;
+		const char* m_pCur = nullptr;
+		const char* m_pEnd = nullptr;
+		::std::uint64_t m_bufOfs = 0;//offset of m_buf[0] in the file
+		bool m_bEof = false;
+
+		//number of blocks to read ahead, 0 turns prefetching off
+		size_t m_prefetchBlocks = 0;
+		::std::unique_ptr<prefetchReader> m_pPrefetch;
+		::std::unique_ptr<decompressor> m_pDecomp;
+
+	protected:
+		void _startPrefetch() {
+			m_pPrefetch.reset();
+			if (m_prefetchBlocks && isOpened()) {
+				m_pPrefetch = ::std::make_unique<prefetchReader>(m_pF, m_bufSize, m_prefetchBlocks, m_pDecomp.get());
+			}
+		}
+
+		void _reset(::std::uint64_t ofs = 0)noexcept {
+			m_pCur = m_pEnd = m_buf.get();
+			m_bufOfs = ofs;
+			m_bEof = false;
+		}
+
+		//moves the unprocessed tail to the beginning of the buffer and reads more data. Returns false on EOF
+		bool _refill() {
+			if (m_bEof) return false;
+			const size_t tail = static_cast<size_t>(m_pEnd - m_pCur);
+			m_bufOfs += static_cast<::std::uint64_t>(m_pCur - m_buf.get());
+			if (tail >= m_bufSize) {
+				//the line is longer than the buffer
+				::std::unique_ptr<char[]> nb(new char[m_bufSize * 2]);
+				::std::memcpy(nb.get(), m_pCur, tail);
+				m_buf = ::std::move(nb);
+				m_bufSize *= 2;
+			} else if (tail) {
+				::std::memmove(m_buf.get(), m_pCur, tail);
+			}
+			const size_t r = m_pPrefetch ? m_pPrefetch->read(m_buf.get() + tail, m_bufSize - tail)
+				: m_pDecomp ? m_pDecomp->read(m_pF, m_buf.get() + tail, m_bufSize - tail)
+				: fread(m_buf.get() + tail, 1, m_bufSize - tail, m_pF);
+			if (r < m_bufSize - tail) m_bEof = true;
+			m_pCur = m_buf.get();
+			m_pEnd = m_pCur + tail + r;
+			return r > 0;
+		}
+
+		//forward seek of a compressed file: consumes the data up to ofs the same way nextLine() does, so a running
+		// prefetch reader stays valid
+		void _skipTo(::std::uint64_t ofs) {
+			T18_ASSERT(m_pDecomp);
+			if (UNLIKELY(ofs < tell())) {
+				T18_ASSERT(!"Compressed file can't be seeked back");
+				throw ::std::logic_error("Compressed file can't be seeked back from " + ::std::to_string(tell())
+					+ " to " + ::std::to_string(ofs));
+			}
+			while (tell() < ofs) {
+				if (m_pCur == m_pEnd && !_refill()) {
+					T18_ASSERT(!"Seek beyond the end of the file");
+					throw ::std::runtime_error("Failed to seek the file to " + ::std::to_string(ofs));
+				}
+				const auto avail = static_cast<::std::uint64_t>(m_pEnd - m_pCur);
+				m_pCur += static_cast<size_t>(::std::min(ofs - tell(), avail));
+			}
+		}
+
+	public:
+		blockFile(const char*const fname, const char*const fmode = "rb", size_t blockSize = defaultBlockSize)
+			: m_buf(new char[blockSize]), m_bufSize(blockSize)
+		{
+			open(fname, fmode);
+		}
+		blockFile(size_t blockSize = defaultBlockSize) : m_buf(new char[blockSize]), m_bufSize(blockSize) {
+			_reset();
+		}
+
+		blockFile(blockFile&&) = default;
+
+		~blockFile() {
+			close();
+		}
+
+		void close()noexcept {
+			//the reader thread must be stopped before the file is closed
+			m_pPrefetch.reset();
+			m_pDecomp.reset();
+			base_class_t::close();
+			_reset();
+		}
+		bool open(const char*const fname, const char*const fmode = "rb") {
+			T18_ASSERT(!fmode || 'r' == fmode[0]);//read only
+			(void)fmode;
+			m_pPrefetch.reset();
+			_reset();
+			const bool r = base_class_t::open(fname, "rb");
+			m_pDecomp = decompressor::make(compressionOf(fname));
+			_startPrefetch();
+			return r;
+		}
+
+		//makes the file to keep nBlocks reads of the block size in flight on a dedicated thread (nBlocks==0 turns it off).
+		//Worth it for cold data on slow or network storage. Takes effect immediately if the file is opened, except for
+		// a compressed file that is already being read - for it the setting is applied by the next open() or seek(0).
+		void setPrefetch(size_t nBlocks) {
+			m_prefetchBlocks = nBlocks;
+			if (!isOpened()) return;
+			if (m_pDecomp) {
+				//a running reader may have decompressed more than was consumed, and that data can't be re-read
+				if (0 == tell()) seek(0);
+			} else {
+				//the reader has probably read more than was consumed, so restarting from the current position
+				seek(tell());
+			}
+		}
+
+		bool isCompressed()const noexcept { return !!m_pDecomp; }
+		size_t prefetchBlocks()const noexcept { return m_prefetchBlocks; }
+
+		//returns the next line [b, e) without '\n'. The last line of a file may not end with '\n'.
+		//The pointers are valid until the next call.
+		bool nextLine(const char*& b, const char*& e) {
+			T18_ASSERT(isOpened());
+			while (true) {
+				const auto pNl = static_cast<const char*>(::std::memchr(m_pCur, '\n', static_cast<size_t>(m_pEnd - m_pCur)));
+				if (pNl) {
+					b = m_pCur;
+					e = pNl;
+					m_pCur = pNl + 1;
+					return true;
+				}
+				if (!_refill()) {
+					if (m_pCur == m_pEnd) return false;
+					//the last line without '\n'
+					b = m_pCur;
+					e = m_pEnd;
+					m_pCur = m_pEnd;
+					return true;
+				}
+			}
+		}
+
+		//offset in the file of a character returned by nextLine()
+		::std::uint64_t offsetOf(const char* p)const noexcept {
+			T18_ASSERT(p >= m_buf.get() && p <= m_pEnd);
+			return m_bufOfs + static_cast<::std::uint64_t>(p - m_buf.get());
+		}
+
+		//offset in the file of the next character to be returned by nextLine()
+		::std::uint64_t tell()const noexcept {
+			return m_bufOfs + static_cast<::std::uint64_t>(m_pCur - m_buf.get());
+		}
+
+		//continues reading from the offset ofs in the file.
+		//For a compressed file ofs must be either 0 (rewinds the file) or not less than tell(). A forward seek costs
+		// the decompression of the data skipped, a seek back to anything but 0 throws std::logic_error - reopen the
+		// file and seek forward instead.
+		void seek(::std::uint64_t ofs) {
+			if (m_pDecomp && ofs) {
+				_skipTo(ofs);
+				return;
+			}
+			m_pPrefetch.reset();
+			if (m_pDecomp) {
+				m_pDecomp->reset();
+				base_class_t::seek(0);
+			} else {
+				base_class_t::seek(ofs);
+			}
+			_reset(ofs);
+			_startPrefetch();
+		}
+
+	};
+
+}
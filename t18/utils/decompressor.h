@@ -0,0 +1,229 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+// streaming decompression of data files. Support of every format is opt-in and requires the corresponding library:
+// define T18_WITH_ZSTD to read zstd files (*.zst) and link with libzstd, define T18_WITH_LZ4 to read lz4 frame
+// files (*.lz4) and link with liblz4.
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+#ifdef T18_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef T18_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
+namespace utils {
+
+	enum class compression { none, zstd, lz4 };
+
+	//detects compression of a file by its extension
+	inline compression compressionOf(const char* fname)noexcept {
+		if (!fname) return compression::none;
+		const auto l = ::std::strlen(fname);
+		auto endsWith = [fname, l](const char* ext)noexcept {
+			const auto el = ::std::strlen(ext);
+			return l >= el && 0 == ::std::memcmp(fname + l - el, ext, el);
+		};
+		if (endsWith(".zst") || endsWith(".zstd")) return compression::zstd;
+		if (endsWith(".lz4")) return compression::lz4;
+		return compression::none;
+	}
+
+	//decompresses a stream read from a FILE* block by block into the caller's buffers
+	class decompressor {
+	public:
+		static constexpr size_t inputBlockSize = 256 * 1024;
+
+	protected:
+		::std::unique_ptr<char[]> m_in;
+		size_t m_inPos = 0;
+		size_t m_inSize = 0;
+		bool m_bInEof = false;
+
+	protected:
+		decompressor() : m_in(new char[inputBlockSize]) {}
+
+		//reads the next block of compressed data if the current one is consumed. Returns false if there's no input left
+		bool _fillInput(FILE* pF) {
+			if (m_inPos < m_inSize) return true;
+			if (m_bInEof) return false;
+			m_inPos = 0;
+			m_inSize = fread(m_in.get(), 1, inputBlockSize, pF);
+			if (m_inSize < inputBlockSize) {
+				if (UNLIKELY(ferror(pF))) {
+					T18_ASSERT(!"Failed to read compressed file");
+					throw ::std::runtime_error("decompressor: failed to read the file");
+				}
+				m_bInEof = true;
+			}
+			return m_inSize > 0;
+		}
+
+		void _resetInput()noexcept {
+			m_inPos = m_inSize = 0;
+			m_bInEof = false;
+		}
+
+		[[noreturn]] static void _throw(const char* what) {
+			T18_ASSERT(!"Failed to decompress the file");
+			throw ::std::runtime_error(::std::string("decompressor: ") + what);
+		}
+
+	public:
+		virtual ~decompressor() {}
+
+		//decompresses the data read from pF into dst. Returns less than n only at the end of the compressed stream
+		virtual size_t read(FILE* pF, char* dst, size_t n) = 0;
+		//prepares to decompress a stream from the beginning, the file must be rewound by the caller
+		virtual void reset() = 0;
+
+		//returns nullptr for compression::none
+		static ::std::unique_ptr<decompressor> make(compression c);
+	};
+
+#ifdef T18_WITH_ZSTD
+	class zstdDecompressor : public decompressor {
+	protected:
+		ZSTD_DStream* m_pS;
+		//0 when a frame has been completely decoded
+		size_t m_lastRet = 0;
+
+	public:
+		zstdDecompressor() : m_pS(ZSTD_createDStream()) {
+			if (!m_pS) throw ::std::bad_alloc();
+			ZSTD_initDStream(m_pS);
+		}
+		~zstdDecompressor() {
+			ZSTD_freeDStream(m_pS);
+		}
+
+		virtual void reset() override {
+			ZSTD_initDStream(m_pS);
+			_resetInput();
+			m_lastRet = 0;
+		}
+
+		virtual size_t read(FILE* pF, char* dst, size_t n) override {
+			ZSTD_outBuffer out{ dst, n, 0 };
+			while (out.pos < out.size) {
+				//an empty input is still fed to flush the data the decoder might hold
+				_fillInput(pF);
+				ZSTD_inBuffer in{ m_in.get(), m_inSize, m_inPos };
+				const auto prevOut = out.pos;
+				const size_t r = ZSTD_decompressStream(m_pS, &out, &in);
+				if (ZSTD_isError(r)) _throw(ZSTD_getErrorName(r));
+				const bool bProgress = in.pos != m_inPos || out.pos != prevOut;
+				m_inPos = in.pos;
+				if (bProgress) {
+					//if there's no progress, r is a hint for the next frame and not the state of the last one
+					m_lastRet = r;
+				} else {
+					if (m_inPos < m_inSize) _throw("decoder is stuck");
+					if (m_bInEof) break;
+				}
+			}
+			if (out.pos < n && m_lastRet) _throw("truncated zstd stream");
+			return out.pos;
+		}
+	};
+#endif
+
+#ifdef T18_WITH_LZ4
+	class lz4Decompressor : public decompressor {
+	protected:
+		LZ4F_dctx* m_pCtx = nullptr;
+		//0 when a frame has been completely decoded
+		size_t m_lastRet = 0;
+
+	protected:
+		void _create() {
+			if (LZ4F_isError(LZ4F_createDecompressionContext(&m_pCtx, LZ4F_VERSION))) throw ::std::bad_alloc();
+		}
+
+	public:
+		lz4Decompressor() {
+			_create();
+		}
+		~lz4Decompressor() {
+			LZ4F_freeDecompressionContext(m_pCtx);
+		}
+
+		virtual void reset() override {
+			LZ4F_freeDecompressionContext(m_pCtx);
+			m_pCtx = nullptr;
+			_create();
+			_resetInput();
+			m_lastRet = 0;
+		}
+
+		virtual size_t read(FILE* pF, char* dst, size_t n) override {
+			size_t outPos = 0;
+			while (outPos < n) {
+				_fillInput(pF);
+				size_t dstSize = n - outPos, srcSize = m_inSize - m_inPos;
+				const size_t r = LZ4F_decompress(m_pCtx, dst + outPos, &dstSize, m_in.get() + m_inPos, &srcSize, nullptr);
+				if (LZ4F_isError(r)) _throw(LZ4F_getErrorName(r));
+				m_inPos += srcSize;
+				outPos += dstSize;
+				if (srcSize || dstSize) {
+					//if there's no progress, r is a hint for the next frame and not the state of the last one
+					m_lastRet = r;
+				} else {
+					if (m_inPos < m_inSize) _throw("decoder is stuck");
+					if (m_bInEof) break;
+				}
+			}
+			if (outPos < n && m_lastRet) _throw("truncated lz4 stream");
+			return outPos;
+		}
+	};
+#endif
+
+	inline ::std::unique_ptr<decompressor> decompressor::make(compression c) {
+		switch (c) {
+		case compression::none:
+			return nullptr;
+
+		case compression::zstd:
+#ifdef T18_WITH_ZSTD
+			return ::std::make_unique<zstdDecompressor>();
+#else
+			T18_ASSERT(!"zstd support isn't compiled in");
+			throw ::std::runtime_error("zstd support isn't compiled in, define T18_WITH_ZSTD");
+#endif
+
+		case compression::lz4:
+#ifdef T18_WITH_LZ4
+			return ::std::make_unique<lz4Decompressor>();
+#else
+			T18_ASSERT(!"lz4 support isn't compiled in");
+			throw ::std::runtime_error("lz4 support isn't compiled in, define T18_WITH_LZ4");
+#endif
+		}
+		T18_ASSERT(!"Unknown compression");
+		throw ::std::logic_error("Unknown compression");
+	}
+
+}
@@ -0,0 +1,154 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "../base_filesystem.h"
+
+namespace utils {
+
+	//blocks a thread until a file is modified, without polling. Uses inotify on Linux and change notifications of the
+	// parent directory on Windows (so wake-ups there might be caused by other files too). Changes that happen between
+	// wait() calls aren't lost, they make the next wait() return immediately. In any case a caller must recheck the
+	// file after the wake-up
+	class fileWatcher {
+	protected:
+#ifdef _WIN32
+		HANDLE m_hChange = INVALID_HANDLE_VALUE;
+		HANDLE m_hStop = NULL;
+#else
+		int m_fd = -1;//inotify instance
+		int m_stopFd = -1;//eventfd that interrupts wait()
+#endif
+
+	protected:
+		[[noreturn]] static void _throw(const char* fname, const char* what, int ec) {
+			using namespace ::std::literals;
+			throw T18_FILESYSTEM_NAMESPACE::filesystem_error(
+				"Failed to watch file ("s + fname + "), reason: "s + what
+				, T18_FILESYSTEM_NAMESPACE::path(fname)
+				, ::std::error_code(ec, ::std::system_category())
+			);
+		}
+
+		void _close()noexcept {
+#ifdef _WIN32
+			if (INVALID_HANDLE_VALUE != m_hChange) FindCloseChangeNotification(m_hChange);
+			if (m_hStop) CloseHandle(m_hStop);
+			m_hChange = INVALID_HANDLE_VALUE;
+			m_hStop = NULL;
+#else
+			if (m_fd >= 0) ::close(m_fd);
+			if (m_stopFd >= 0) ::close(m_stopFd);
+			m_fd = m_stopFd = -1;
+#endif
+		}
+
+	public:
+		~fileWatcher() {
+			_close();
+		}
+		fileWatcher(const char*const fname) {
+			T18_ASSERT(fname);
+#ifdef _WIN32
+			auto dir = T18_FILESYSTEM_NAMESPACE::path(fname).parent_path().string();
+			if (dir.empty()) dir = ".";
+			m_hStop = CreateEventA(NULL, TRUE, FALSE, NULL);
+			if (!m_hStop) _throw(fname, "CreateEvent failed", static_cast<int>(GetLastError()));
+			m_hChange = FindFirstChangeNotificationA(dir.c_str(), FALSE, FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+			if (INVALID_HANDLE_VALUE == m_hChange) {
+				const auto ec = static_cast<int>(GetLastError());
+				_close();
+				_throw(fname, "FindFirstChangeNotification failed", ec);
+			}
+#else
+			m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (m_fd < 0) _throw(fname, "inotify_init1 failed", errno);
+			if (inotify_add_watch(m_fd, fname, IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+				const auto ec = errno;
+				_close();
+				_throw(fname, "inotify_add_watch failed", ec);
+			}
+			m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (m_stopFd < 0) {
+				const auto ec = errno;
+				_close();
+				_throw(fname, "eventfd failed", ec);
+			}
+#endif
+		}
+
+		fileWatcher(const fileWatcher&) = delete;
+		fileWatcher& operator=(const fileWatcher&) = delete;
+
+		//waits until the file is changed, stop() is called or timeoutMs passes (negative value means no timeout).
+		//Returns true if the file might have changed
+		bool wait(const int timeoutMs = -1) {
+#ifdef _WIN32
+			const HANDLE hs[2] = { m_hStop, m_hChange };
+			const auto r = WaitForMultipleObjects(2, hs, FALSE, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+			if (WAIT_OBJECT_0 + 1 != r) return false;
+			FindNextChangeNotification(m_hChange);
+			return true;
+#else
+			pollfd fds[2] = { { m_stopFd, POLLIN, 0 }, { m_fd, POLLIN, 0 } };
+			int r;
+			do {
+				r = poll(fds, 2, timeoutMs);
+			} while (r < 0 && EINTR == errno);
+			//the stop event is never consumed, so it keeps interrupting subsequent waits
+			if (r <= 0 || (fds[0].revents & POLLIN) || !(fds[1].revents & POLLIN)) return false;
+
+			//draining all queued events, their content doesn't matter
+			alignas(inotify_event) char buf[4096];
+			while (read(m_fd, buf, sizeof(buf)) > 0) {}
+			return true;
+#endif
+		}
+
+		//interrupts current and all subsequent wait() calls. Could be called from any thread
+		void stop()noexcept {
+#ifdef _WIN32
+			SetEvent(m_hStop);
+#else
+			const ::std::uint64_t one = 1;
+			const auto r = write(m_stopFd, &one, sizeof(one));
+			(void)r;
+#endif
+		}
+	};
+
+}
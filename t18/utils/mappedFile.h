@@ -0,0 +1,154 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "../base_filesystem.h"
+
+namespace utils {
+
+	//read-only memory mapping of a whole file. Pages are loaded by the OS on the first access, so opening the file is
+	//almost free and reading it sequentially is bound by page faults/readahead only.
+	class mappedFile {
+	protected:
+		const ::std::uint8_t* m_pData = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		HANDLE m_hFile = INVALID_HANDLE_VALUE;
+		HANDLE m_hMap = NULL;
+#endif
+
+	protected:
+		[[noreturn]] static void _throw(const char* fname, const char* what, int ec) {
+			using namespace ::std::literals;
+			throw T18_FILESYSTEM_NAMESPACE::filesystem_error(
+				"Failed to map file ("s + fname + "), reason: "s + what
+				, T18_FILESYSTEM_NAMESPACE::path(fname)
+				, ::std::error_code(ec, ::std::system_category())
+			);
+		}
+
+	public:
+		~mappedFile() {
+			close();
+		}
+		mappedFile(const char*const fname) {
+			open(fname);
+		}
+		mappedFile() {}
+
+		mappedFile(const mappedFile&) = delete;
+		mappedFile& operator=(const mappedFile&) = delete;
+
+		void close()noexcept {
+#ifdef _WIN32
+			if (m_pData) UnmapViewOfFile(m_pData);
+			if (m_hMap) CloseHandle(m_hMap);
+			if (INVALID_HANDLE_VALUE != m_hFile) CloseHandle(m_hFile);
+			m_hMap = NULL;
+			m_hFile = INVALID_HANDLE_VALUE;
+#else
+			if (m_pData) munmap(const_cast<::std::uint8_t*>(m_pData), m_size);
+#endif
+			m_pData = nullptr;
+			m_size = 0;
+		}
+
+		//empty files are opened successfully, but data() is nullptr for them
+		void open(const char*const fname) {
+			close();
+			T18_ASSERT(fname);
+
+#ifdef _WIN32
+			m_hFile = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING
+				, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (INVALID_HANDLE_VALUE == m_hFile) _throw(fname, "CreateFile failed", static_cast<int>(GetLastError()));
+
+			LARGE_INTEGER sz;
+			if (!GetFileSizeEx(m_hFile, &sz)) {
+				const auto ec = static_cast<int>(GetLastError());
+				close();
+				_throw(fname, "GetFileSizeEx failed", ec);
+			}
+			if (0 == sz.QuadPart) return;
+
+			m_hMap = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (!m_hMap) {
+				const auto ec = static_cast<int>(GetLastError());
+				close();
+				_throw(fname, "CreateFileMapping failed", ec);
+			}
+			m_pData = static_cast<const ::std::uint8_t*>(MapViewOfFile(m_hMap, FILE_MAP_READ, 0, 0, 0));
+			if (!m_pData) {
+				const auto ec = static_cast<int>(GetLastError());
+				close();
+				_throw(fname, "MapViewOfFile failed", ec);
+			}
+			m_size = static_cast<size_t>(sz.QuadPart);
+#else
+			const int fd = ::open(fname, O_RDONLY);
+			if (fd < 0) _throw(fname, "open failed", errno);
+
+			struct stat st;
+			if (fstat(fd, &st) != 0) {
+				const auto ec = errno;
+				::close(fd);
+				_throw(fname, "fstat failed", ec);
+			}
+			if (0 == st.st_size) {
+				::close(fd);
+				return;
+			}
+			void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			const auto ec = errno;
+			::close(fd);
+			if (MAP_FAILED == p) _throw(fname, "mmap failed", ec);
+
+			madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+			m_pData = static_cast<const ::std::uint8_t*>(p);
+			m_size = static_cast<size_t>(st.st_size);
+#endif
+		}
+
+		const ::std::uint8_t* data()const noexcept { return m_pData; }
+		size_t size()const noexcept { return m_size; }
+
+		bool isOpened()const noexcept { return !!m_pData; }
+		operator bool()const noexcept { return isOpened(); }
+	};
+
+}
@@ -0,0 +1,81 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <list>
+#include <boost/circular_buffer.hpp>
+
+namespace utils {
+
+	//a tree of (component name -> bytes) used to report how much memory the framework objects hold.
+	//bytes is an estimate of memory held by the component itself (its object size plus owned heap blocks),
+	//children report their own parts, so the full size of a component is total()
+	struct memFootprint {
+		::std::string name;
+		size_t bytes = 0;
+		::std::vector<memFootprint> children;
+
+		memFootprint() = default;
+		memFootprint(::std::string n, size_t b = 0) : name(::std::move(n)), bytes(b) {}
+
+		size_t total()const noexcept {
+			size_t r = bytes;
+			for (const auto& c : children) r += c.total();
+			return r;
+		}
+
+		memFootprint& add(memFootprint&& c) {
+			children.push_back(::std::move(c));
+			return children.back();
+		}
+		memFootprint& add(::std::string n, size_t b = 0) {
+			return add(memFootprint(::std::move(n), b));
+		}
+
+		//returns nullptr if there's no direct child with the name
+		const memFootprint* find(const char* n)const noexcept {
+			for (const auto& c : children) {
+				if (c.name == n) return &c;
+			}
+			return nullptr;
+		}
+
+		void print(FILE* f = stdout, unsigned lvl = 0)const {
+			::std::fprintf(f, "%*s%s: %zu bytes", static_cast<int>(lvl * 2), "", name.c_str(), total());
+			if (children.size()) ::std::fprintf(f, " (own %zu)", bytes);
+			::std::fputc('\n', f);
+			for (const auto& c : children) c.print(f, lvl + 1);
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	//heap bytes owned by standard containers (object size itself isn't included)
+	template<typename T, typename A>
+	size_t heapBytes(const ::std::vector<T, A>& c)noexcept { return c.capacity() * sizeof(T); }
+
+	template<typename T, typename A>
+	size_t heapBytes(const ::boost::circular_buffer<T, A>& c)noexcept { return c.capacity() * sizeof(T); }
+
+	//list nodes are at least two pointers bigger than the value
+	template<typename T, typename A>
+	size_t heapBytes(const ::std::list<T, A>& c)noexcept { return c.size() * (sizeof(T) + 2 * sizeof(void*)); }
+
+}
@@ -18,8 +18,14 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+#include <stdexcept>
 #include <stdio.h>
 #include <clocale>
+#include <cerrno>
+#ifdef _WIN32
+#include <share.h>
+#endif
 
 #include "../base_filesystem.h"
 
@@ -57,12 +63,34 @@ namespace utils {
 			}
 		}
 		bool open(const char*const fname, const char*const fmode) {
+			return _open(fname, fmode, false);
+		}
+		//opens the file allowing others to read and write it at the same time (fopen_s() on Windows denies writing to
+		// a file opened by someone else). For files that are appended by one process while being read by another
+		bool openShared(const char*const fname, const char*const fmode) {
+			return _open(fname, fmode, true);
+		}
+
+	protected:
+		bool _open(const char*const fname, const char*const fmode, const bool bShared) {
 			using namespace ::std::literals;
 			close();
 
 			if (!fname || !fmode) return false;
 
+#ifdef _WIN32
+			int ec = 0;
+			if (bShared) {
+				m_pF = _fsopen(fname, fmode, _SH_DENYNO);
+				if (!m_pF) ec = errno;
+			} else {
+				ec = fopen_s(&m_pF, fname, fmode);
+			}
+#else
+			//there are no mandatory locks, files are always shared
+			(void)bShared;
 			auto ec = fopen_s(&m_pF, fname, fmode);
+#endif
 			if (ec) {
 				T18_ASSERT(!m_pF);
 				char buf[128];
@@ -77,15 +105,41 @@ namespace utils {
 			return true;
 		}
 
+	public:
 		pFILE_t get()noexcept{
 			T18_ASSERT(m_pF);
 			return m_pF;
 		}
 		operator pFILE_t() noexcept { return get(); }
 
+		//current position in the file, the file must be opened
+		::std::uint64_t tell() {
+			T18_ASSERT(m_pF);
+			const auto r = _ftelli64(m_pF);
+			if (UNLIKELY(r < 0)) {
+				T18_ASSERT(!"Failed to get position in the file");
+				throw ::std::runtime_error("Failed to get position in the file");
+			}
+			return static_cast<::std::uint64_t>(r);
+		}
+		void seek(::std::uint64_t ofs) {
+			T18_ASSERT(m_pF);
+			if (UNLIKELY(0 != _fseeki64(m_pF, static_cast<long long>(ofs), SEEK_SET))) {
+				T18_ASSERT(!"Failed to seek the file");
+				throw ::std::runtime_error("Failed to seek the file to " + ::std::to_string(ofs));
+			}
+		}
+
 		bool isOpened()const noexcept { return !!m_pF; }
 		operator bool()const noexcept { return isOpened(); }
 
+		//size and last modification time of a file, that are used to check that a sidecar file is still valid for it
+		static void stamp(const char* fn, ::std::uint64_t& fileSize, ::std::int64_t& mtime) {
+			const T18_FILESYSTEM_NAMESPACE::path p(fn);
+			fileSize = static_cast<::std::uint64_t>(T18_FILESYSTEM_NAMESPACE::file_size(p));
+			mtime = static_cast<::std::int64_t>(T18_FILESYSTEM_NAMESPACE::last_write_time(p).time_since_epoch().count());
+		}
+
 		static bool exist(const char* fn)noexcept {
 			FILE *pF;
 			if (0 == fopen_s(&pF, fn, "r")) {
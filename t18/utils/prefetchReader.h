@@ -0,0 +1,163 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include <exception>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+#include "decompressor.h"
+
+namespace utils {
+
+	//prefetchReader keeps up to nBlocks large reads of a file in flight on a dedicated read-ahead thread, so the consumer
+	// (blockFile) gets the data from memory instead of waiting on every block read. If a decompressor is given, the
+	// decompression is also done by the read-ahead thread.
+	//The file must not be used directly by anyone else while the reader exists.
+	class prefetchReader {
+	protected:
+		struct block {
+			::std::unique_ptr<char[]> data;
+			size_t size = 0;
+		};
+
+		FILE* const m_pF;
+		decompressor* const m_pDecomp;
+		const size_t m_blockSize;
+
+		//ring of blocks. Blocks [m_head, m_head+m_filled) are read and waiting for the consumer
+		::std::vector<block> m_blocks;
+		size_t m_head = 0;
+		size_t m_filled = 0;
+		//position in the block m_head consumed so far
+		size_t m_headPos = 0;
+
+		bool m_bEof = false;
+		bool m_bStop = false;
+		//set if reading failed, it's rethrown to the consumer after all the data read is consumed
+		::std::exception_ptr m_err;
+
+		::std::mutex m_mtx;
+		::std::condition_variable m_cvFilled;
+		::std::condition_variable m_cvFreed;
+		::std::thread m_thread;
+
+	protected:
+		void _work()noexcept {
+			::std::unique_lock<::std::mutex> lk(m_mtx);
+			while (true) {
+				m_cvFreed.wait(lk, [this]() { return m_bStop || m_filled < m_blocks.size(); });
+				if (m_bStop) return;
+
+				auto& b = m_blocks[(m_head + m_filled) % m_blocks.size()];
+				lk.unlock();
+				//the block isn't visible to the consumer until m_filled is incremented
+				size_t r = 0;
+				::std::exception_ptr err;
+				try {
+					if (m_pDecomp) {
+						r = m_pDecomp->read(m_pF, b.data.get(), m_blockSize);
+					} else {
+						r = fread(b.data.get(), 1, m_blockSize, m_pF);
+						if (r < m_blockSize && ferror(m_pF)) throw ::std::runtime_error("prefetchReader: failed to read the file");
+					}
+				} catch (...) {
+					err = ::std::current_exception();
+				}
+				const bool bShort = err || r < m_blockSize;
+				lk.lock();
+
+				b.size = r;
+				if (r) ++m_filled;
+				if (bShort) {
+					m_bEof = true;
+					m_err = err;
+				}
+				m_cvFilled.notify_one();
+				if (bShort) return;
+			}
+		}
+
+	public:
+		prefetchReader(FILE* pF, size_t blockSize, size_t nBlocks, decompressor* pDecomp = nullptr)
+			: m_pF(pF), m_pDecomp(pDecomp), m_blockSize(blockSize), m_blocks(nBlocks)
+		{
+			T18_ASSERT(pF && blockSize > 0 && nBlocks > 0);
+#ifndef _WIN32
+			//it's just a hint, so errors are ignored
+			posix_fadvise(fileno(pF), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+			for (auto& b : m_blocks) b.data.reset(new char[blockSize]);
+			m_thread = ::std::thread([this]() { _work(); });
+		}
+
+		prefetchReader(const prefetchReader&) = delete;
+		prefetchReader& operator=(const prefetchReader&) = delete;
+
+		~prefetchReader()noexcept {
+			{
+				::std::lock_guard<::std::mutex> lk(m_mtx);
+				m_bStop = true;
+			}
+			m_cvFreed.notify_one();
+			if (m_thread.joinable()) m_thread.join();
+		}
+
+		//fread()-like: copies up to n bytes to dst. Returns less than n only at the end of file.
+		size_t read(char* dst, size_t n) {
+			size_t r = 0;
+			::std::unique_lock<::std::mutex> lk(m_mtx);
+			while (r < n) {
+				m_cvFilled.wait(lk, [this]() { return m_filled > 0 || m_bEof; });
+				if (!m_filled) {
+					if (UNLIKELY(m_err)) ::std::rethrow_exception(m_err);
+					break;
+				}
+
+				auto& b = m_blocks[m_head];
+				const size_t c = ::std::min(n - r, b.size - m_headPos);
+				//the block is owned by the consumer until it's released, so no need to hold the lock for copying
+				lk.unlock();
+				::std::memcpy(dst + r, b.data.get() + m_headPos, c);
+				lk.lock();
+
+				r += c;
+				m_headPos += c;
+				if (m_headPos == b.size) {
+					m_headPos = 0;
+					m_head = (m_head + 1) % m_blocks.size();
+					--m_filled;
+					m_cvFreed.notify_one();
+				}
+			}
+			return r;
+		}
+	};
+
+}
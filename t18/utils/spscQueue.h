@@ -0,0 +1,85 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace utils {
+
+	//bounded lock-free queue for exactly one producer thread and exactly one consumer thread.
+	//Capacity is rounded up to a power of two. T must be default constructible and copy assignable.
+	template<typename T>
+	class spscQueue {
+	public:
+		typedef T value_t;
+
+	protected:
+		//producer and consumer indexes live on different cache lines to prevent false sharing
+		alignas(64) ::std::atomic<size_t> m_head{ 0 };//next element to pop, written by the consumer only
+		alignas(64) ::std::atomic<size_t> m_tail{ 0 };//next element to push, written by the producer only
+
+		alignas(64) const size_t m_mask;
+		::std::unique_ptr<value_t[]> m_buf;
+
+	protected:
+		static constexpr size_t _roundCapacity(size_t c)noexcept {
+			size_t r = 2;
+			while (r < c) r <<= 1;
+			return r;
+		}
+
+	public:
+		explicit spscQueue(size_t cap) : m_mask(_roundCapacity(cap) - 1), m_buf(new value_t[m_mask + 1]) {}
+
+		spscQueue(const spscQueue&) = delete;
+		spscQueue& operator=(const spscQueue&) = delete;
+
+		size_t capacity()const noexcept { return m_mask + 1; }
+
+		//approximate, as the other side may change the queue concurrently
+		size_t size()const noexcept {
+			return m_tail.load(::std::memory_order_acquire) - m_head.load(::std::memory_order_acquire);
+		}
+
+		//producer side
+		bool full()const noexcept {
+			return m_tail.load(::std::memory_order_relaxed) - m_head.load(::std::memory_order_acquire) > m_mask;
+		}
+		bool tryPush(const value_t& v) {
+			const auto t = m_tail.load(::std::memory_order_relaxed);
+			if (t - m_head.load(::std::memory_order_acquire) > m_mask) return false;
+			m_buf[t & m_mask] = v;
+			m_tail.store(t + 1, ::std::memory_order_release);
+			return true;
+		}
+
+		//consumer side
+		bool empty()const noexcept {
+			return m_head.load(::std::memory_order_relaxed) == m_tail.load(::std::memory_order_acquire);
+		}
+		bool tryPop(value_t& v) {
+			const auto h = m_head.load(::std::memory_order_relaxed);
+			if (h == m_tail.load(::std::memory_order_acquire)) return false;
+			v = m_buf[h & m_mask];
+			m_head.store(h + 1, ::std::memory_order_release);
+			return true;
+		}
+	};
+
+}
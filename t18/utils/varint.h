@@ -0,0 +1,63 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdint>
+
+//LEB128-like variable length encoding of integers with a zigzag mapping for signed values.
+//Small values (by absolute value) take less bytes: [-64,63] takes 1 byte, [-8192, 8191] takes 2 bytes and so on.
+
+namespace utils {
+	namespace varint {
+
+		constexpr ::std::uint64_t zigzag(::std::int64_t v)noexcept {
+			return (static_cast<::std::uint64_t>(v) << 1) ^ static_cast<::std::uint64_t>(v >> 63);
+		}
+		constexpr ::std::int64_t unzigzag(::std::uint64_t v)noexcept {
+			return static_cast<::std::int64_t>(v >> 1) ^ -static_cast<::std::int64_t>(v & 1);
+		}
+
+		//the longest encoding of a 64 bit value
+		constexpr size_t maxBytes = 10;
+
+		//ContT must have push_back() of uint8_t
+		template<typename ContT>
+		void put(ContT& c, ::std::uint64_t v) {
+			while (v >= 0x80) {
+				c.push_back(static_cast<::std::uint8_t>(v | 0x80));
+				v >>= 7;
+			}
+			c.push_back(static_cast<::std::uint8_t>(v));
+		}
+		template<typename ContT>
+		void put_signed(ContT& c, ::std::int64_t v) { put(c, zigzag(v)); }
+
+		//reads a value and advances the pointer. There's no bounds checking, the data must be valid
+		inline ::std::uint64_t get(const ::std::uint8_t*& p)noexcept {
+			::std::uint64_t r = 0;
+			unsigned sh = 0;
+			while (*p & 0x80) {
+				r |= static_cast<::std::uint64_t>(*p++ & 0x7f) << sh;
+				sh += 7;
+			}
+			return r | (static_cast<::std::uint64_t>(*p++) << sh);
+		}
+		inline ::std::int64_t get_signed(const ::std::uint8_t*& p)noexcept { return unzigzag(get(p)); }
+
+	}
+}
@@ -0,0 +1,191 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+#include "spinlock.h"
+
+namespace utils {
+
+	//a fixed set of worker threads each owning a deque of tasks. A worker takes the most recently pushed task of its own
+	// deque and, when it's empty, steals the oldest task of another worker, so workers that got short tasks help the
+	// ones that got long tasks instead of becoming idle. Tasks submitted from a worker thread go to the worker's own
+	// deque. An exception escaping a task is stored and rethrown by the next wait() (only the first one is kept).
+	class workStealingPool {
+	public:
+		typedef ::std::function<void()> task_t;
+
+	protected:
+		//cache line aligned to prevent false sharing of locks of neighbour workers
+		struct alignas(64) worker_t {
+			spinlock lock;
+			::std::deque<task_t> tasks;
+		};
+
+	protected:
+		::std::vector<::std::unique_ptr<worker_t>> m_workers;
+		::std::vector<::std::thread> m_threads;
+
+		//queued but not yet taken tasks. It's incremented before a task is pushed, so it may only overestimate
+		::std::atomic<size_t> m_nQueued{ 0 };
+		//submitted but not yet finished tasks
+		::std::atomic<size_t> m_nUnfinished{ 0 };
+		::std::atomic<size_t> m_nextWorker{ 0 };
+
+		//guards the fields below and is used to sleep when there's no work
+		::std::mutex m_mtx;
+		::std::condition_variable m_cvWork, m_cvDone;
+		::std::exception_ptr m_err;
+		bool m_bStop = false;
+
+		inline static thread_local const workStealingPool* t_pPool = nullptr;
+		inline static thread_local size_t t_workerIdx = 0;
+
+	protected:
+		bool _take(const size_t idx, task_t& t)noexcept {
+			{
+				auto& w = *m_workers[idx];
+				spinlock_guard g(w.lock);
+				if (!w.tasks.empty()) {
+					t = ::std::move(w.tasks.back());
+					w.tasks.pop_back();
+					m_nQueued.fetch_sub(1, ::std::memory_order_relaxed);
+					return true;
+				}
+			}
+			const auto n = m_workers.size();
+			for (size_t k = 1; k < n; ++k) {
+				auto& v = *m_workers[(idx + k) % n];
+				spinlock_guard g(v.lock);
+				if (!v.tasks.empty()) {
+					t = ::std::move(v.tasks.front());
+					v.tasks.pop_front();
+					m_nQueued.fetch_sub(1, ::std::memory_order_relaxed);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void _exec(task_t& t)noexcept {
+			try {
+				t();
+			} catch (...) {
+				::std::lock_guard<::std::mutex> lk(m_mtx);
+				if (!m_err) m_err = ::std::current_exception();
+			}
+			t = nullptr;
+			if (1 == m_nUnfinished.fetch_sub(1, ::std::memory_order_acq_rel)) {
+				::std::lock_guard<::std::mutex> lk(m_mtx);
+				m_cvDone.notify_all();
+			}
+		}
+
+		void _work(const size_t idx)noexcept {
+			t_pPool = this;
+			t_workerIdx = idx;
+			task_t t;
+			while (true) {
+				if (_take(idx, t)) {
+					_exec(t);
+				} else {
+					::std::unique_lock<::std::mutex> lk(m_mtx);
+					m_cvWork.wait(lk, [this]() { return m_bStop || m_nQueued.load(::std::memory_order_relaxed) > 0; });
+					if (m_bStop) return;
+				}
+			}
+		}
+
+	public:
+		//nThreads==0 means to use all hardware threads
+		explicit workStealingPool(size_t nThreads = 0) {
+			if (!nThreads) nThreads = ::std::max(1u, ::std::thread::hardware_concurrency());
+			m_workers.reserve(nThreads);
+			for (size_t i = 0; i < nThreads; ++i) m_workers.push_back(::std::make_unique<worker_t>());
+			m_threads.reserve(nThreads);
+			for (size_t i = 0; i < nThreads; ++i) {
+				m_threads.emplace_back([this, i]() { _work(i); });
+			}
+		}
+
+		workStealingPool(const workStealingPool&) = delete;
+		workStealingPool& operator=(const workStealingPool&) = delete;
+
+		//tasks that haven't been started yet are dropped
+		~workStealingPool()noexcept {
+			{
+				::std::lock_guard<::std::mutex> lk(m_mtx);
+				m_bStop = true;
+			}
+			m_cvWork.notify_all();
+			for (auto& t : m_threads) {
+				if (t.joinable()) t.join();
+			}
+		}
+
+		size_t size()const noexcept { return m_threads.size(); }
+
+		//index [0, size()) of the worker thread that runs the calling task, handy to address per worker data
+		size_t workerIndex()const noexcept {
+			T18_ASSERT(this == t_pPool || !"Must be called from a task of the pool");
+			return t_workerIdx;
+		}
+
+		void submit(task_t&& t) {
+			T18_ASSERT(t);
+			const auto n = m_workers.size();
+			const auto idx = this == t_pPool ? t_workerIdx : m_nextWorker.fetch_add(1, ::std::memory_order_relaxed) % n;
+
+			m_nUnfinished.fetch_add(1, ::std::memory_order_relaxed);
+			m_nQueued.fetch_add(1, ::std::memory_order_relaxed);
+			{
+				auto& w = *m_workers[idx];
+				spinlock_guard g(w.lock);
+				w.tasks.push_back(::std::move(t));
+			}
+			//taking the mutex guarantees that a worker that is about to sleep would see the new task
+			{
+				::std::lock_guard<::std::mutex> lk(m_mtx);
+			}
+			m_cvWork.notify_one();
+		}
+
+		//blocks until every submitted task is finished. Mustn't be called from a task.
+		void wait() {
+			T18_ASSERT(this != t_pPool || !"Can't wait for the pool from its own task");
+			::std::unique_lock<::std::mutex> lk(m_mtx);
+			m_cvDone.wait(lk, [this]() { return 0 == m_nUnfinished.load(::std::memory_order_acquire); });
+			if (m_err) {
+				auto e = ::std::move(m_err);
+				m_err = nullptr;
+				::std::rethrow_exception(e);
+			}
+		}
+	};
+
+}
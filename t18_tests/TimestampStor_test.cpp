@@ -71,3 +71,46 @@ TEST(TestDTStor, Creation) {
 	ASSERT_EQ(ts.timestamp(1).Date(), milDate(20180101));
 	ASSERT_EQ(ts.timestamp(1).Time(), milTime(144000));
 }
+
+TEST(TestDTStor, TimeLookup) {
+	using namespace t18;
+	for (int bDayIdx = 0; bDayIdx < 2; ++bDayIdx) {
+		TimestampStorWrap ts(5);
+		if (bDayIdx) ts.enableDayIndex(2);
+
+		ASSERT_EQ(ts.barAt(mxTimestamp(tag_milDT(), 20180101, 100000)), 0);
+		ASSERT_EQ(ts.lowerBound(mxTimestamp(tag_milDT(), 20180101, 100000)), 0);
+
+		ts.storeBar(milDate(20180101), milTime(100000));
+		ts.storeBar(milDate(20180101), milTime(110000));
+		ts.storeBar(milDate(20180102), milTime(100000));
+		ts.storeBar(milDate(20180102), milTime(110000));
+		ts.storeBar(milDate(20180102), milTime(120000));
+		ts.storeBar(milDate(20180103), milTime(100000));
+		//20180101 100000 has been pushed out of the storage
+
+		ASSERT_EQ(ts.indexOf(mxTimestamp(tag_milDT(), 20180103, 100000)), 0);
+		ASSERT_EQ(ts.indexOf(mxTimestamp(tag_milDT(), 20180102, 110000)), 2);
+		ASSERT_EQ(ts.indexOf(mxTimestamp(tag_milDT(), 20180102, 103000)), ts.size());
+		ASSERT_EQ(ts.indexOf(mxTimestamp(tag_milDT(), 20180101, 100000)), ts.size());
+
+		ASSERT_EQ(ts.barAt(mxTimestamp(tag_milDT(), 20180102, 103000)), 3);
+		ASSERT_EQ(ts.barAt(mxTimestamp(tag_milDT(), 20180104, 103000)), 0);
+		ASSERT_EQ(ts.barAt(mxTimestamp(tag_milDT(), 20180101, 103000)), ts.size());
+
+		ASSERT_EQ(ts.lowerBound(mxTimestamp(tag_milDT(), 20180102, 103000)), 2);
+		ASSERT_EQ(ts.lowerBound(mxTimestamp(tag_milDT(), 20180101, 90000)), 4);
+		ASSERT_EQ(ts.lowerBound(mxTimestamp(tag_milDT(), 20180104, 90000)), ts.size());
+
+		ASSERT_EQ(ts.dayFirstBar(mxDate(2018, 1, 3)), 0);
+		ASSERT_EQ(ts.dayFirstBar(mxDate(2018, 1, 2)), 3);
+		ASSERT_EQ(ts.dayFirstBar(mxDate(2018, 1, 1)), 4);
+		ASSERT_EQ(ts.dayFirstBar(mxDate(2017, 12, 31)), ts.size());
+		ASSERT_EQ(ts.dayFirstBar(mxDate(2018, 1, 4)), ts.size());
+
+		ASSERT_EQ(ts.barAt(mxDate(2018, 1, 2), mxTime(11, 30, 0)), 2);
+		ASSERT_EQ(ts.barAt(mxDate(2018, 1, 2), mxTime(9, 30, 0)), ts.size());
+		ASSERT_EQ(ts.barAt(mxDate(2018, 1, 3), mxTime(23, 0, 0)), 0);
+		ASSERT_EQ(ts.barAt(mxDate(2018, 1, 1), mxTime(12, 0, 0)), 4);
+	}
+}
@@ -69,6 +69,29 @@ TEST(AlgsTests, Open2real_t) {
 	);
 }
 
+TEST(AlgsTests, MemoryFootprint) {
+	using namespace hana::literals;
+
+	TsCont_t<real_t> src(50);
+
+	algs::Elementile_c elm(20, src, algPrms(Prm("len"_s, 11), Prm("rank"_s, 9)));
+	const auto fpElm = elm.memoryFootprint("Elementile");
+	ASSERT_EQ(fpElm.name, "Elementile");
+	ASSERT_FALSE(fpElm.find("state"));
+	ASSERT_TRUE(fpElm.find("TStor") && fpElm.find("adapters"));
+	ASSERT_EQ(fpElm.find("TStor")->bytes, 11 * sizeof(real_t));
+	ASSERT_EQ(fpElm.find("adapters")->bytes, 20 * sizeof(real_t));
+	ASSERT_EQ(fpElm.total(), sizeof(algs::Elementile_c) + 31 * sizeof(real_t));
+
+	//DEMA has a state and doesn't own the dest
+	TsCont_t<real_t> dest(10);
+	algs::DEMA dema(dest, src, algPrms(Prm("len"_s, 20)));
+	const auto fpDema = dema.memoryFootprint();
+	ASSERT_TRUE(fpDema.find("state"));
+	ASSERT_FALSE(fpDema.find("TStor") || fpDema.find("adapters"));
+	ASSERT_EQ(fpDema.total(), sizeof(algs::DEMA));
+}
+
 #include "publicIntf_tickerServer.h"
 #include "../t18/tfConverter/dailyhm.h"
 
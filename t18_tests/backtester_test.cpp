@@ -23,6 +23,14 @@
 #include "../t18/feeder/adapters/csv.h"
 #include "../t18/feeder/singleFile.h"
 #include "../t18/exec/assocTradeInfo.h"
+#include "../t18/exec/paramSweep.h"
+#include "../t18/exec/multiBacktester.h"
+#include "../t18/feeder/sharedHistory.h"
+#include "publicIntf_tickerServer.h"
+
+#include <fstream>
+#include <cmath>
+#include <atomic>
 
 using namespace t18;
 using namespace std::literals;
@@ -58,8 +66,216 @@ TEST(TestBacktester, Basic) {
 	ASSERT_EQ(pTrd->plannedClose().q, real_t(1));
 	ASSERT_EQ(pTrd->volumeInMarket(), real_t(0));
 	ASSERT_EQ(pTrd->tradeProfit(), real_t(-10));
+
+	const auto fp = h.memoryFootprint();
+	const auto pTi = fp.find("tradingInterface");
+	const auto pMds = fp.find("MarketDataStor");
+	ASSERT_TRUE(pTi && pMds);
+	ASSERT_TRUE(pTi->find("trades"));
+	ASSERT_GE(pTi->find("trades")->bytes, sizeof(tradeEx));
+	ASSERT_EQ(pMds->children.size(), 1);
+	ASSERT_EQ(pMds->children[0].name, "test");
+	ASSERT_TRUE(pMds->children[0].find("tf"));
+	ASSERT_GE(fp.total(), sizeof(h));
+}
+
+TEST(TestBacktester, LevelsIndex) {
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+	typedef typename Ticker_t::bestPriceInfo_t bestPriceInfo_t;
+
+	exec::backtester<utils::make_set_t<Ticker_t>> h;
+	h.silence();
+	auto& tickr = h.newTicker<Ticker_t>("test", real_t(.01), tfid_hst(), size_t(1), 1);
+	tickr.setLotSize(1);
+	auto& tb = tickr.getTickerBase();
+
+	mxTimestamp tx(tag_milDT(), 20180101, 192000);
+	h.setBestBidAsk(tickr, bestPriceInfo_t(tx, 100, 1), bestPriceInfo_t(tx, real_t(100.01), 1));
+
+	const auto newTrd = [&h, &tb](bool bLong, real_t sl, real_t tp) {
+		auto pTrd = h.newMarketTrade(bLong, tb, 1);
+		if (sl > 0) pTrd->setStopLoss(PriceAbs(tb, sl));
+		if (tp > 0) pTrd->setTakeProfit(PriceAbs(tb, tp));
+		return pTrd->TradeId();
+	};
+	const auto l0 = newTrd(true, 95, 0), l1 = newTrd(true, 90, 0), l2 = newTrd(true, 0, 105);
+	const auto l3 = newTrd(true, 0, 103), l4 = newTrd(true, 93, 110);
+	//moved out of the bar
+	const auto l5 = newTrd(true, 97, 0);
+	h.getTrade(l5).updateStopLossLvl(92);
+	//closed before the bar
+	const auto l6 = newTrd(true, 99, 101);
+	h.getTrade(l6).closeByMarket(TradeCloseReason::Normal);
+	ASSERT_EQ(h.openedTradesCount(), 6);
+
+	h._handleNewBarClose(tb, tsohlcv(tag_milDT(), 20180101, 192100, 100, 104, 94, 100, 1));
+	ASSERT_EQ(h.openedTradesCount(), 4);
+	ASSERT_EQ(h.getTrade(l0).getCloseReason(), TradeCloseReason::StopLoss);
+	ASSERT_EQ(h.getTrade(l3).getCloseReason(), TradeCloseReason::TakeProfit);
+	ASSERT_EQ(h.getTrade(l6).getCloseReason(), TradeCloseReason::Normal);
+	for (const auto tid : { l1, l2, l4, l5 }) {
+		ASSERT_EQ(h.getTrade(tid).getState(), TradeState::inMarket);
+	}
+
+	//gap up
+	h._handleNewBarOpen(tb, tsq_data(mxTimestamp(tag_milDT(), 20180101, 192200), 106));
+	ASSERT_EQ(h.openedTradesCount(), 3);
+	ASSERT_EQ(h.getTrade(l2).getCloseReason(), TradeCloseReason::TakeProfit);
+
+	//gap down hits stoplosses of l4 and l5, but closing of l4 closes l5 too
+	{
+		const auto hCb = h.registerOnTradeStatus(&tb, [&h, l4, l5](trade& t) {
+			if (t.TradeId() == l4 && t.is_Closed()) h.getTrade(l5).closeByMarket(TradeCloseReason::Normal);
+		});
+		h._handleNewBarOpen(tb, tsq_data(mxTimestamp(tag_milDT(), 20180101, 192300), 91));
+	}
+	ASSERT_EQ(h.openedTradesCount(), 1);
+	ASSERT_EQ(h.getTrade(l4).getCloseReason(), TradeCloseReason::StopLoss);
+	ASSERT_EQ(h.getTrade(l5).getCloseReason(), TradeCloseReason::Normal);
+	ASSERT_EQ(h.getTrade(l1).getState(), TradeState::inMarket);
+
+	ASSERT_TRUE(h.memoryFootprint().find("levelsIndex"));
+}
+
+TEST(TestBacktester, StopOrdersBook) {
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+	typedef typename Ticker_t::bestPriceInfo_t bestPriceInfo_t;
+
+	exec::backtester<utils::make_set_t<Ticker_t>> h;
+	h.silence();
+	auto& tickr = h.newTicker<Ticker_t>("test", real_t(.01), tfid_hst(), size_t(1), 1);
+	tickr.setLotSize(1);
+	auto& tb = tickr.getTickerBase();
+
+	mxTimestamp tx(tag_milDT(), 20180101, 192000);
+	h.setBestBidAsk(tickr, bestPriceInfo_t(tx, 100, 1), bestPriceInfo_t(tx, real_t(100.01), 1));
+
+	h.newBuyStop(tb, PriceAbs(tb, 103), 1);
+	h.newBuyStop(tb, PriceAbs(tb, 105), 2);
+	//inactive until 19:30
+	h.newBuyStop(tb, PriceAbs(tb, 102), 3, PriceAbs(), PriceAbs(), TimeFilter(mxTime(tag_milTime(), 193000)));
+	ASSERT_EQ(h.orderStopCount(), 3);
+
+	h._handleNewBarClose(tb, tsohlcv(tag_milDT(), 20180101, 192100, 100, 104, 99, 100, 1));
+	ASSERT_EQ(h.orderStopCount(), 2);
+	ASSERT_EQ(h.tradesCount(), 1);
+	ASSERT_EQ(h.getTrade(0).plannedVolume(), 1);
+
+	//both remaining orders are triggered and executed in the order of placement
+	h._handleNewBarOpen(tb, tsq_data(mxTimestamp(tag_milDT(), 20180101, 193100), 106));
+	ASSERT_EQ(h.orderStopCount(), 0);
+	ASSERT_EQ(h.tradesCount(), 3);
+	ASSERT_EQ(h.getTrade(1).plannedVolume(), 2);
+	ASSERT_EQ(h.getTrade(2).plannedVolume(), 3);
+
+	//slots are recycled
+	h.newBuyStop(tb, PriceAbs(tb, 120), 1);
+	h.newBuyStop(tb, PriceAbs(tb, 121), 1);
+	ASSERT_EQ(h.orderStopCount(), 2);
+	h.orderStopDropAll();
+	ASSERT_EQ(h.orderStopCount(), 0);
+	h.newBuyStop(tb, PriceAbs(tb, 120), 1);
+	ASSERT_EQ(h.orderStopCount(), 1);
+	h._handleNewBarClose(tb, tsohlcv(tag_milDT(), 20180101, 193200, 106, 110, 105, 107, 1));
+	ASSERT_EQ(h.orderStopCount(), 1);
+	ASSERT_EQ(h.tradesCount(), 3);
 }
 
+TEST(TestBacktester, OpenedTrades) {
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+	typedef typename Ticker_t::bestPriceInfo_t bestPriceInfo_t;
+
+	exec::backtester<utils::make_set_t<Ticker_t>> h;
+	h.silence();
+	auto& tickr = h.newTicker<Ticker_t>("test", real_t(.01), tfid_hst(), size_t(1), 1);
+	tickr.setLotSize(1);
+	auto& tb = tickr.getTickerBase();
+
+	mxTimestamp tx(tag_milDT(), 20180101, 192000);
+	h.setBestBidAsk(tickr, bestPriceInfo_t(tx, 100, 1), bestPriceInfo_t(tx, real_t(100.01), 1));
+
+	const size_t nTrades = 20;
+	for (size_t i = 0; i < nTrades; ++i) h.newMarketLong(tb, 1);
+	ASSERT_EQ(h.openedTradesCount(), nTrades);
+
+	const auto openedIds = [&h]() {
+		::std::vector<size_t> r;
+		static_cast<const decltype(h)&>(h).forEachOpenedTrade([&r](const trade& t) { r.push_back(t.TradeId()); });
+		return r;
+	};
+
+	//closing the visited trade and the next one from inside of the loop, opening a new trade that isn't visited
+	::std::vector<size_t> visited;
+	h.forEachOpenedTrade([&h, &tb, &visited](trade& t) {
+		visited.push_back(t.TradeId());
+		if (t.TradeId() % 4 == 0) {
+			t.closeByMarket(TradeCloseReason::Normal);
+			h.getTrade(t.TradeId() + 1).closeByMarket(TradeCloseReason::Normal);
+			h.newMarketLong(tb, 1);
+		}
+	});
+	ASSERT_EQ(visited.size(), nTrades / 2 + nTrades / 4);
+	for (size_t i = 0; i < visited.size(); ++i) {
+		ASSERT_NE(visited[i] % 4, 1);
+		if (i) ASSERT_LT(visited[i - 1], visited[i]);
+	}
+	ASSERT_EQ(h.openedTradesCount(), nTrades / 2 + nTrades / 4);
+
+	//opening order is preserved when holes are dropped
+	for (size_t i = 2; i < nTrades; i += 4) h.getTrade(i).closeByMarket(TradeCloseReason::Normal);
+	const auto ids = openedIds();
+	ASSERT_EQ(ids.size(), h.openedTradesCount());
+	ASSERT_EQ(ids.size(), nTrades / 4 + nTrades / 4);
+	ASSERT_TRUE(::std::is_sorted(ids.begin(), ids.end()));
+	for (const auto tid : ids) {
+		ASSERT_TRUE(tid >= nTrades || tid % 4 == 3);
+	}
+	ASSERT_TRUE(h.anyOpenedTrades4Ticker(tb));
+}
+
+TEST(TestBacktester, TimedCallbackClosesLastTrade) {
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef publicIntf_tickerServer<TickerTimeframes_hdm> Ticker_t;
+
+	exec::backtester<utils::make_set_t<Ticker_t>> h;
+	h.silence();
+	auto& tickr = h.newTicker<Ticker_t>("test", real_t(.01), tfid_hst(), size_t(1), 1);
+	tickr.setLotSize(1);
+	auto& tb = tickr.getTickerBase();
+
+	//a bar of the previous day
+	const tsohlcv prevBar(tag_milDT(), 20180101, 235900, 100, 101, 99, 100, 10);
+	tickr.newBarOpen(tsq_data(prevBar.TS(), prevBar.o()));
+	tickr.newBarAggregate(prevBar);
+	ASSERT_TRUE(h.newMarketLong(tb, 1));
+	ASSERT_EQ(h.openedTradesCount(), 1);
+
+	size_t nCalls = 0;
+	const auto hCb = h.scheduleTimedCallbackIfOpenedTrades(tag_milTime(), 100000, &tb, [&h, &nCalls](const mxTimestamp&) {
+		++nCalls;
+		h.forEachOpenedTrade([](trade& t) { t.closeByMarket(TradeCloseReason::Normal); });
+	});
+
+	//the callback sets the best bid/ask to the previous day and closes the only trade, then a new trade is opened at
+	// the bar open
+	const tsq_data tso(mxTimestamp(tag_milDT(), 20180102, 100000), 200);
+	h._handleNewBarOpen(tb, tso);
+	ASSERT_EQ(nCalls, 1);
+	ASSERT_EQ(h.openedTradesCount(), 0);
+	ASSERT_EQ(h.getTrade(0).plannedClose().q, prevBar.c);
+
+	const auto pTrd = h.newMarketLong(tb, 1);
+	ASSERT_TRUE(pTrd);
+	ASSERT_EQ(pTrd->plannedOpen().q, tso.q + tb.getMinPriceDelta());
+	ASSERT_EQ(pTrd->plannedOpen().TS(), tso.TS());
+}
 
 struct TrdInfo {
 	int i;
@@ -148,3 +364,294 @@ TEST(TestBacktester, MaCrossO) {
 		bt.bt_exportTradeList_LinesFmt(t, ::std::string(TESTS_TESTDATA_DIR) + "gen_MaCrossO_" +t.Name()+ "_tradelistLines.csv");
 	});
 }
+
+namespace {
+	//makes M1 history of 112 days with 3 bars a day, that is wavy enough to make MaCross trade
+	void _makeSweepData(const char* fname) {
+		::std::ofstream dst(fname, ::std::ios::binary | ::std::ios::trunc);
+		char buf[128];
+		int d = 0;
+		for (int mon = 1; mon <= 4; ++mon) {
+			for (int day = 1; day <= 28; ++day, ++d) {
+				const double p = 100 + 8 * ::std::sin(d / 5.) + 3 * ::std::sin(d / 1.7);
+				for (const int t : { 100000, 182500, 184500 }) {
+					const double q = p + (t - 100000) * 1e-6;
+					sprintf_s(buf, "%d,%d,%.2f,%.2f,%.2f,%.2f,100\r\n", 20180000 + mon * 100 + day, t, q, q + .05, q - .05, q);
+					dst << buf;
+				}
+			}
+		}
+	}
+
+	ts::MaCrossSetup<> _sweepSetup(size_t maFast) {
+		ts::MaCrossSetup<> so;
+		so.maFast = maFast;
+		so.pTickerName = "sweep";
+		so.tickerMinPriceDelta = real_t(.01);
+		so.tickerLotSize = 1u;
+		return so;
+	}
+
+	void _expectSameMetrics(const exec::sweepMetrics& l, const exec::sweepMetrics& r) {
+		EXPECT_EQ(l.nTrades, r.nTrades);
+		EXPECT_EQ(l.nClosed, r.nClosed);
+		EXPECT_EQ(l.nProfitable, r.nProfitable);
+		EXPECT_DOUBLE_EQ(l.equity, r.equity);
+		EXPECT_DOUBLE_EQ(l.profit, r.profit);
+	}
+
+	//a TS for the ticker of _sweepSetup(). If bOnClose is set, it trades on closes of base bars: every close closes
+	// the opened trade and opens a new one. Otherwise it holds a trade with a stoploss and a takeprofit, opening a new
+	// one at a bar open once the previous is closed
+	class barTrader final : public ts::_base_poly<barTrader> {
+		typedef ts::_base_poly<barTrader> base_class_t;
+		typedef ts::MaCrossCompiletimePrms ct_prms_t;
+
+	public:
+		typedef ct_prms_t::TheTicker_t ticker_t;
+
+	protected:
+		ticker_t& m_Ticker;
+		const bool m_bOnClose;
+		utils::regHandle m_hOpen, m_hClose;
+
+	public:
+		template<typename MktT, typename SetupT>
+		barTrader(MktT& m, exec::tradingInterface& t, SetupT& so)
+			: base_class_t(t)
+			, m_Ticker(m.template getTicker<ticker_t>(so.pTickerName))
+			, m_bOnClose(so.bOnClose)
+			, m_hOpen(m_Ticker.template getTf<ct_prms_t::baseTf_hst>()
+				.registerOnNewBarOpen(::std::bind(&barTrader::onBarOpen, this, ::std::placeholders::_1)))
+			, m_hClose(m_Ticker.template getTf<ct_prms_t::baseTf_hst>()
+				.registerOnNewBarClose(::std::bind(&barTrader::onBarClose, this, ::std::placeholders::_1)))
+		{}
+
+		void onBarOpen(const tsq_data&) {
+			if (!m_bOnClose && !m_Trading.openedTradesCount()) {
+				const auto& tb = m_Ticker.getTickerBase();
+				m_Trading.newMarketLong(m_Ticker, 1, PriceRel(tb, real_t(.01)), PriceRel(tb, real_t(.02)));
+			}
+		}
+		void onBarClose(const tsohlcv&) {
+			if (m_bOnClose) {
+				m_Trading.forEachOpenedTrade([](trade& t) { t.closeByMarket(TradeCloseReason::Normal); });
+				m_Trading.newMarketLong(m_Ticker, 1);
+			}
+		}
+	};
+
+	struct barTraderSetup : ts::MaCrossSetup<> {
+		typedef barTrader ts_t;
+
+		bool bOnClose = false;
+
+		barTraderSetup(bool b) : ts::MaCrossSetup<>(_sweepSetup(10)), bOnClose(b) {}
+	};
+}
+
+TEST(TestBacktester, ParamSweep) {
+	typedef ts::MaCrossSetup<> setup_t;
+	typedef exec::paramSweep<setup_t> sweep_t;
+
+	const char* fname = TESTS_TESTDATA_DIR "gen_sweep.csv";
+	_makeSweepData(fname);
+	typedef feeder::sharedHistory<tsohlcv> hist_t;
+	const auto hist = hist_t::make<feeder::singleFile, feeder::adapters::csv_tsohlcv>(hana::make_tuple(fname), hana::make_tuple());
+	ASSERT_EQ(hist.size(), 112 * 3);
+
+	const auto mkSetup = [](size_t maFast) { return _sweepSetup(maFast); };
+	const ::std::vector<size_t> prms{ 2, 3, 4, 5, 7, 10, 15, 20 };
+
+	//reference results of sequential runs
+	::std::vector<exec::sweepMetrics> ref;
+	for (const auto p : prms) {
+		auto so = mkSetup(p);
+		auto pBt = ::std::make_unique<sweep_t::backtester_t>();
+		pBt->silence();
+		auto h = hist;
+		pBt->run(so, h);
+		ref.push_back(exec::sweepMetrics::of(*pBt));
+	}
+	ASSERT_TRUE(::std::any_of(ref.begin(), ref.end(), [](const auto& m) { return m.nTrades > 0; }));
+
+	for (const size_t nThreads : { 1, 4 }) {
+		sweep_t sw(nThreads);
+		ASSERT_EQ(sw.threadsCount(), nThreads);
+		const auto res = sw.run(prms, hist, mkSetup);
+		ASSERT_EQ(res.size(), prms.size());
+		for (size_t i = 0; i < prms.size(); ++i) {
+			_expectSameMetrics(res[i], ref[i]);
+		}
+	}
+	//the runs don't keep the shared data
+	ASSERT_EQ(hist.use_count(), 1);
+
+	//the market is made once per worker with the most demanding setup
+	{
+		sweep_t sw(2);
+		sw.keepMarket(mkSetup(20));
+		const auto res = sw.run(prms, hist, mkSetup);
+		ASSERT_EQ(res.size(), prms.size());
+		for (size_t i = 0; i < prms.size(); ++i) {
+			_expectSameMetrics(res[i], ref[i]);
+		}
+	}
+
+	sweep_t sw(3);
+	size_t next = 0;
+	const auto r = sw.runGenerated<size_t>([&prms, &next](size_t& p) {
+		if (next >= prms.size()) return false;
+		p = prms[next++];
+		return true;
+	}, hist, mkSetup, [](const sweep_t::backtester_t& bt) { return bt.tradesCount(); });
+	ASSERT_EQ(r.first, prms);
+	ASSERT_EQ(r.second.size(), prms.size());
+	for (size_t i = 0; i < prms.size(); ++i) {
+		ASSERT_EQ(r.second[i], ref[i].nTrades);
+	}
+}
+
+TEST(TestBacktester, Reset) {
+	typedef ts::MaCrossSetup<> setup_t;
+	typedef exec::backtester<setup_t::ct_prms_t::TickersSet_t> bt_t;
+
+	const char* fname = TESTS_TESTDATA_DIR "gen_sweep.csv";
+	_makeSweepData(fname);
+	const auto hist = feeder::sharedHistory<tsohlcv>::make<feeder::singleFile, feeder::adapters::csv_tsohlcv>(
+		hana::make_tuple(fname), hana::make_tuple());
+
+	//reference results of fresh backtesters
+	const auto fresh = [&hist](size_t maFast) {
+		auto so = _sweepSetup(maFast);
+		auto pBt = ::std::make_unique<bt_t>();
+		pBt->silence();
+		auto h = hist;
+		pBt->run(so, h);
+		return exec::sweepMetrics::of(*pBt);
+	};
+	const auto ref10 = fresh(10), ref7 = fresh(7);
+	ASSERT_GT(ref10.nTrades, 0);
+
+	auto pBt = ::std::make_unique<bt_t>();
+	pBt->silence();
+	pBt->SetInitDeposit(money_t(1e6));
+	auto run = [&pBt, &hist](size_t maFast) {
+		auto so = _sweepSetup(maFast);
+		auto h = hist;
+		pBt->run(so, h);
+		return exec::sweepMetrics::of(*pBt);
+	};
+	_expectSameMetrics(run(10), ref10);
+	const auto nBars = pBt->getTicker<setup_t::TheTicker_t>("sweep").getTf<setup_t::mainTf_hst>().TotalBars();
+	ASSERT_GT(nBars, 0);
+
+	//full reset, the setup is made again
+	pBt->reset();
+	ASSERT_EQ(pBt->tickersCount(), 0);
+	ASSERT_EQ(pBt->tradesCount(), 0);
+	_expectSameMetrics(run(10), ref10);
+
+	//keeping the market
+	for (const size_t maFast : { 10, 7, 10 }) {
+		pBt->reset(true);
+		ASSERT_EQ(pBt->tickersCount(), 1);
+		ASSERT_EQ(pBt->tradesCount(), 0);
+		auto& tickr = pBt->getTicker<setup_t::TheTicker_t>("sweep");
+		ASSERT_EQ(tickr.getTf<setup_t::mainTf_hst>().TotalBars(), 0);
+		ASSERT_TRUE(tickr.notFilledYet());
+
+		_expectSameMetrics(run(maFast), 10 == maFast ? ref10 : ref7);
+		ASSERT_EQ(tickr.getTf<setup_t::mainTf_hst>().TotalBars(), nBars);
+	}
+}
+
+TEST(TestBacktester, MultiTenant) {
+	typedef ts::MaCrossSetup<> setup_t;
+	typedef setup_t::ct_prms_t::TickersSet_t TickersSet_t;
+
+	const char* fname = TESTS_TESTDATA_DIR "gen_sweep.csv";
+	_makeSweepData(fname);
+	const auto hist = feeder::sharedHistory<tsohlcv>::make<feeder::singleFile, feeder::adapters::csv_tsohlcv>(
+		hana::make_tuple(fname), hana::make_tuple());
+
+	const ::std::vector<size_t> prms{ 10, 7, 15, 3 };
+	::std::vector<setup_t> setups;
+	for (const auto p : prms) setups.push_back(_sweepSetup(p));
+
+	auto pMbt = ::std::make_unique<exec::multiBacktester<TickersSet_t>>();
+	pMbt->silence();
+	auto h = hist;
+	pMbt->run(setups, h);
+	ASSERT_EQ(pMbt->tenantsCount(), prms.size());
+	ASSERT_EQ(pMbt->tickersCount(), 1);
+	ASSERT_GT(pMbt->memoryFootprint().total(), sizeof(exec::multiBacktester<TickersSet_t>));
+
+	size_t nTrades = 0;
+	for (size_t i = 0; i < prms.size(); ++i) {
+		auto so = _sweepSetup(prms[i]);
+		auto pBt = ::std::make_unique<exec::backtester<TickersSet_t>>();
+		pBt->silence();
+		auto hb = hist;
+		pBt->run(so, hb);
+		const auto ref = exec::sweepMetrics::of(*pBt);
+		nTrades += ref.nTrades;
+		_expectSameMetrics(exec::sweepMetrics::of(pMbt->tenant(i)), ref);
+	}
+	ASSERT_GT(nTrades, 0);
+}
+
+TEST(TestBacktester, MultiTenantIsolation) {
+	typedef barTraderSetup setup_t;
+	typedef setup_t::ct_prms_t::TickersSet_t TickersSet_t;
+
+	const char* fname = TESTS_TESTDATA_DIR "gen_sweep.csv";
+	_makeSweepData(fname);
+	const auto hist = feeder::sharedHistory<tsohlcv>::make<feeder::singleFile, feeder::adapters::csv_tsohlcv>(
+		hana::make_tuple(fname), hana::make_tuple());
+
+	//stoploss/takeprofit checks of the holder set the best bid/ask of the ticker to the bar span on every bar close,
+	// while the other tenant trades on bar closes
+	::std::vector<setup_t> setups{ setup_t(false), setup_t(true), setup_t(false) };
+
+	auto pMbt = ::std::make_unique<exec::multiBacktester<TickersSet_t>>();
+	pMbt->silence();
+	auto h = hist;
+	pMbt->run(setups, h);
+	ASSERT_EQ(pMbt->tenantsCount(), setups.size());
+
+	for (size_t i = 0; i < setups.size(); ++i) {
+		setup_t so(setups[i].bOnClose);
+		auto pBt = ::std::make_unique<exec::backtester<TickersSet_t>>();
+		pBt->silence();
+		auto hb = hist;
+		pBt->run(so, hb);
+		const auto ref = exec::sweepMetrics::of(*pBt);
+		ASSERT_GT(ref.nClosed, 1);
+		_expectSameMetrics(exec::sweepMetrics::of(pMbt->tenant(i)), ref);
+	}
+}
+
+TEST(TestBacktester, WorkStealingPool) {
+	::utils::workStealingPool pool(4);
+	ASSERT_EQ(pool.size(), 4);
+
+	//tasks spawn subtasks that go to the own deque of a worker and are stolen by others
+	::std::atomic<size_t> sum{ 0 };
+	for (size_t i = 0; i < 8; ++i) {
+		pool.submit([&pool, &sum, i]() {
+			for (size_t j = 0; j < 100; ++j) {
+				pool.submit([&sum, i, j]() { sum.fetch_add(i * 100 + j, ::std::memory_order_relaxed); });
+			}
+		});
+	}
+	pool.wait();
+	ASSERT_EQ(sum.load(), 800 * 799 / 2);
+
+	pool.submit([]() { throw ::std::runtime_error("task failed"); });
+	pool.submit([&sum]() { sum.store(0); });
+	ASSERT_THROW(pool.wait(), ::std::runtime_error);
+	ASSERT_EQ(sum.load(), 0);
+	//the error is reported once
+	pool.wait();
+}
@@ -0,0 +1,128 @@
+/*
+    This file is a part of t18 project (C++17 framework for algotrading)
+    Copyright (C) 2019, Arech (aradvert@gmail.com; https://github.com/Arech)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "stdafx.h"
+
+#include "../t18/feeder/adapters/csv.h"
+#include "../t18/feeder/adapters/fastCsv.h"
+#include "../t18/feeder/binFile.h"
+#include "../t18/feeder/convCache.h"
+#include "../t18/tfConverter/dailyhm.h"
+#include "publicIntf_tickerServer.h"
+#include "dummyMktFwd.h"
+
+using namespace std::literals;
+
+T18_COMP_SILENCE_REQ_GLOBAL_CONSTR
+
+TEST(TestBinFile, Bars) {
+	using namespace t18;
+
+	typedef feeder::adapters::csv_tsohlcv adapt_t;
+	typedef feeder::binFile<tsohlcv> binFile_t;
+	const char* binFname = TESTS_TESTDATA_DIR "gen_dtohlcv.t18bin";
+
+	ASSERT_EQ(binFile_t::convert<adapt_t>(TESTS_TESTDATA_DIR "dtohlcv.csv", binFname, "dtohlcv", 1), 5);
+
+	binFile_t bf(binFname);
+	ASSERT_EQ(bf.size(), 5);
+	ASSERT_STREQ(bf.tickerName(), "dtohlcv");
+	ASSERT_EQ(bf.tfMinutes(), 1);
+	ASSERT_EQ(bf.header().colOffs[1] % 64, 0);
+
+	const tsohlcv b0(tag_milDT(), 20170103, 100000, 173.4100000, 173.5000000, 173.1500000, 173.1500000, 148360);
+	ASSERT_EQ(bf[0], b0);
+	ASSERT_EQ(bf.firstTs(), b0.TS());
+	ASSERT_EQ(bf[2], tsohlcv(tag_milDT(), 20170103, 100200, 173.2600000, 173.4000000, 173.2500000, 173.2500000, 46330));
+	ASSERT_EQ(bf.lastTs(), bf.TS(4));
+	ASSERT_EQ(bf.lowerBound(bf.TS(3)), 3);
+	ASSERT_EQ(bf.lowerBound(bf.lastTs().next()), 5);
+
+	//unsorted records are refused before the file is made
+	const char* badFname = TESTS_TESTDATA_DIR "gen_unsorted.t18bin";
+	::std::remove(badFname);
+	ASSERT_THROW(binFile_t::write(badFname, ::std::vector<tsohlcv>{ bf[1], bf[0] }, "bad"), ::std::logic_error);
+	ASSERT_FALSE(T18_FILESYSTEM_NAMESPACE::exists(badFname));
+
+	//the same data must be fed as via the csv feeder
+	typedef decltype("base"_s) btf_ht;
+	typedef timeseries::Timeframe<tfConverter::baseOhlc> tfBase_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>))> piticker_t;
+
+	piticker_t tCsv(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 5u, 1);
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(tCsv)>(tCsv), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", adapt_t());
+
+	piticker_t tBin(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 5u, 1);
+	bf.feed(tBin);
+
+	const auto& tfCsv = tCsv.getTf("base"_s);
+	const auto& tfBin = tBin.getTf("base"_s);
+	ASSERT_EQ(tfBin.TotalBars(), tfCsv.TotalBars());
+	for (size_t i = 0; i < tfCsv.size(); ++i) {
+		ASSERT_EQ(tfBin.bar(i), tfCsv.bar(i));
+	}
+
+}
+
+TEST(TestBinFile, ConvCache) {
+	using namespace t18;
+
+	typedef feeder::adapters::csv_tsohlcv adapt_t;
+	typedef tfConverter::dailyhm<tsohlcv> conv_t;
+	const char* srcFname = TESTS_TESTDATA_DIR "dtohlcv.csv";
+
+	feeder::convCache cache(TESTS_TESTDATA_DIR "gen_convCache");
+	cache.invalidate<adapt_t>(srcFname, conv_t(2));
+
+	bool bHit = true;
+	const auto fn = cache.get<adapt_t>(srcFname, conv_t(2), &bHit);
+	ASSERT_FALSE(bHit);
+	ASSERT_EQ(cache.get<adapt_t>(srcFname, conv_t(2), &bHit), fn);
+	ASSERT_TRUE(bHit);
+	//a different converter parameter or adapter makes a different entry
+	ASSERT_NE(cache.entryFor<adapt_t>(srcFname, conv_t(5)), fn);
+	ASSERT_NE(cache.entryFor<feeder::adapters::fastCsv_tsohlcv>(srcFname, conv_t(2)), fn);
+	//the digest of the source is stored to be reused while the source is unchanged
+	ASSERT_TRUE(::std::any_of(T18_FILESYSTEM_NAMESPACE::directory_iterator(TESTS_TESTDATA_DIR "gen_convCache")
+		, T18_FILESYSTEM_NAMESPACE::directory_iterator(), [](const auto& e) {
+			return e.path().extension() == feeder::convCache::digestExt;
+		}));
+
+	feeder::binFile<tsohlcv> bf(fn.c_str());
+	ASSERT_EQ(bf.size(), 3);
+	ASSERT_EQ(bf.tfMinutes(), 2);
+	ASSERT_EQ(bf[0], tsohlcv(tag_milDT(), 20170103, 100000, 173.4100000, 173.5000000, 173.1100000, 173.2600000, 100970 + 148360));
+	ASSERT_EQ(bf[1], tsohlcv(tag_milDT(), 20170103, 100200, 173.2600000, 173.5300000, 173.2500000, 173.5200000, 96690 + 46330));
+	ASSERT_EQ(bf[2], tsohlcv(tag_milDT(), 20170103, 100400, 173.5200000, 173.8400000, 173.0000000, 173.5900000, 248160));
+
+	//feeding cached bars must give the same timeframe as converting the source on the fly
+	typedef decltype("m2"_s) m2_ht;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<m2_ht, timeseries::Timeframe<conv_t>>))> piticker_t;
+
+	piticker_t tSrc(TickerId::forEveryone(), "test", real_t(.01), "m2"_s, 5u, 2);
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(tSrc)>(tSrc), 0, srcFname, adapt_t());
+
+	piticker_t tCached(TickerId::forEveryone(), "test", real_t(.01), "m2"_s, 5u, 2);
+	bf.feed(tCached);
+
+	const auto& tfSrc = tSrc.getTf("m2"_s);
+	const auto& tfCached = tCached.getTf("m2"_s);
+	ASSERT_EQ(tfCached.TotalBars(), tfSrc.TotalBars());
+	for (size_t i = 0; i < tfSrc.size(); ++i) {
+		ASSERT_EQ(tfCached.bar(i), tfSrc.bar(i));
+	}
+}
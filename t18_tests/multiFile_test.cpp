@@ -18,8 +18,11 @@
 #include "stdafx.h"
 
 #include "../t18/feeder/multiFile.h"
+#include "../t18/feeder/sharedTimeline.h"
+#include "../t18/feeder/adapters/fastCsv.h"
 //#include "../t18/tfConverter/dailyhm.h"
 #include "publicIntf_timeframeServer.h"
+#include <fstream>
 #include "../t18/market/MarketDataStorServ.h"
 
 using namespace std::literals;
@@ -112,6 +115,233 @@ TEST(TestMultiFile, SequenceSame) {
 	ASSERT_EQ(rc, 15);
 }
 
+TEST(TestMultiFile, Groups) {
+	using namespace t18;
+
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+
+	Mdss_tester<utils::make_set_t<Ticker_t>> mkt;
+
+	auto& tickr1 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_same_1", real_t(.01), tfid_hst(), 3u, 1);
+	auto& tickr2 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_same_2", real_t(.01), tfid_hst(), 3u, 1);
+	auto& tickr3 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_same_3", real_t(.01), tfid_hst(), 3u, 1);
+
+	//records with the same timestamp must be emitted in the order of tickers
+	::std::vector<const char*> order;
+	auto h1 = tickr1.registerOnNewBarOpen([&](const tsq_data&) { order.push_back(tickr1.Name()); });
+	auto h2 = tickr2.registerOnNewBarOpen([&](const tsq_data&) { order.push_back(tickr2.Name()); });
+	auto h3 = tickr3.registerOnNewBarOpen([&](const tsq_data&) { order.push_back(tickr3.Name()); });
+
+	::std::vector<mxTimestamp> groups;
+	size_t lastGroupEnd = 0;
+	feeder::multiFile<> feed(TESTS_TESTDATA_DIR);
+	feed(mkt, [&](mxTimestamp ts) {
+		ASSERT_TRUE(groups.empty() || groups.back() < ts);
+		ASSERT_EQ(order.size() - lastGroupEnd, 3);
+		lastGroupEnd = order.size();
+		groups.push_back(ts);
+	});
+
+	ASSERT_EQ(groups.size(), 5);
+	ASSERT_EQ(order.size(), 15);
+	for (size_t i = 0; i < order.size(); i += 3) {
+		ASSERT_EQ(order[i], tickr1.Name());
+		ASSERT_EQ(order[i + 1], tickr2.Name());
+		ASSERT_EQ(order[i + 2], tickr3.Name());
+	}
+}
+
+TEST(TestMultiFile, ParallelParsing) {
+	using namespace t18;
+
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+
+	//pipelined parsing must feed exactly the same sequence as the single threaded mode
+	auto feedAll = [](size_t nThreads, size_t queueSize) {
+		Mdss_tester<utils::make_set_t<Ticker_t>> mkt;
+		::std::vector<::std::pair<::std::string, tsohlcv>> r;
+		auto& tickr1 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_1", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr2 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_2", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr3 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_3", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr4 = mkt.newTicker<Ticker_t>("dtohlcv", real_t(.01), tfid_hst(), 3u, 1);
+		auto h1 = tickr1.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr1.Name(), b); });
+		auto h2 = tickr2.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr2.Name(), b); });
+		auto h3 = tickr3.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr3.Name(), b); });
+		auto h4 = tickr4.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr4.Name(), b); });
+
+		feeder::multiFile<> feed(TESTS_TESTDATA_DIR);
+		feed.setParsingThreads(nThreads, queueSize);
+		feed(mkt);
+		return r;
+	};
+
+	const auto ref = feedAll(0, 1);
+	ASSERT_EQ(ref.size(), 5 + 3 + 2 + 5);
+	ASSERT_EQ(feedAll(1, 1), ref);
+	ASSERT_EQ(feedAll(2, 2), ref);
+	ASSERT_EQ(feedAll(8, 1024), ref);
+}
+
+TEST(TestMultiFile, OpenFilesLimit) {
+	using namespace t18;
+
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+
+	//feeding with a bounded pool of open files must produce exactly the same sequence as the default mode
+	auto feedAll = [](auto&& feed) {
+		Mdss_tester<utils::make_set_t<Ticker_t>> mkt;
+		::std::vector<::std::pair<::std::string, tsohlcv>> r;
+		auto& tickr1 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_1", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr2 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_2", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr3 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_3", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr4 = mkt.newTicker<Ticker_t>("dtohlcv", real_t(.01), tfid_hst(), 3u, 1);
+		auto h1 = tickr1.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr1.Name(), b); });
+		auto h2 = tickr2.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr2.Name(), b); });
+		auto h3 = tickr3.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr3.Name(), b); });
+		auto h4 = tickr4.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr4.Name(), b); });
+		feed(mkt);
+		return r;
+	};
+
+	feeder::multiFile<> ref(TESTS_TESTDATA_DIR);
+	const auto refLog = feedAll(ref);
+	ASSERT_EQ(refLog.size(), 5 + 3 + 2 + 5);
+
+	feeder::multiFile<> f(TESTS_TESTDATA_DIR);
+	f.setOpenFilesLimit(1, 1);
+	ASSERT_EQ(feedAll(f), refLog);
+	f.setOpenFilesLimit(2, 2);
+	ASSERT_EQ(feedAll(f), refLog);
+	f.setOpenFilesLimit(3, 1024);
+	ASSERT_EQ(feedAll(f), refLog);
+
+	//block reading files are suspended and resumed too
+	typedef utils::makeMap_t<decltype(hana::make_pair(hana::type_c<void>, hana::type_c<feeder::adapters::fastCsv_tsohlcv>))> fastMap_t;
+	feeder::multiFile<fastMap_t> ff(TESTS_TESTDATA_DIR);
+	ff.setOpenFilesLimit(1, 1);
+	ASSERT_EQ(feedAll(ff), refLog);
+	ff.setOpenFilesLimit(2, 3);
+	ASSERT_EQ(feedAll(ff), refLog);
+}
+
+TEST(TestMultiFile, SharedTimeline) {
+	using namespace t18;
+
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+
+	typedef ::std::vector<::std::pair<::std::string, tsohlcv>> log_t;
+	//feeds tickers 1..3 and records bars & groups
+	auto feedAll = [](auto&& feed, log_t& r, ::std::vector<mxTimestamp>& groups) {
+		Mdss_tester<utils::make_set_t<Ticker_t>> mkt;
+		auto& tickr1 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_1", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr2 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_2", real_t(.01), tfid_hst(), 3u, 1);
+		auto& tickr3 = mkt.newTicker<Ticker_t>("dtohlcv_csvLib_seq_diff_3", real_t(.01), tfid_hst(), 3u, 1);
+		auto h1 = tickr1.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr1.Name(), b); });
+		auto h2 = tickr2.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr2.Name(), b); });
+		auto h3 = tickr3.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.emplace_back(tickr3.Name(), b); });
+		feed(mkt, [&groups](mxTimestamp ts) { groups.push_back(ts); });
+	};
+
+	log_t ref;
+	::std::vector<mxTimestamp> refGroups;
+	feeder::multiFile<> mf(TESTS_TESTDATA_DIR);
+	feedAll(mf, ref, refGroups);
+	ASSERT_EQ(ref.size(), 5 + 3 + 2);
+
+	//the timeline contains one more ticker, that isn't present in the market
+	const auto tl = feeder::sharedTimeline<>::make(TESTS_TESTDATA_DIR, { "dtohlcv", "dtohlcv_csvLib_seq_diff_1"
+		, "dtohlcv_csvLib_seq_diff_2", "dtohlcv_csvLib_seq_diff_3" });
+	ASSERT_EQ(tl.tickersCount(), 4);
+	ASSERT_EQ(tl.size(), 5 + 5 + 3 + 2);
+	ASSERT_EQ(tl.findTicker("dtohlcv_csvLib_seq_diff_2"), 2);
+
+	//replaying the same timeline several times
+	for (int i = 0; i < 2; ++i) {
+		log_t r;
+		::std::vector<mxTimestamp> groups;
+		auto run = tl;
+		ASSERT_EQ(tl.use_count(), 2);
+		feedAll(run, r, groups);
+		ASSERT_EQ(r, ref);
+		ASSERT_EQ(groups, refGroups);
+	}
+
+	//records with equal timestamps are fed in the order of the market's tickers, whatever the order in the timeline is
+	{
+		log_t r;
+		::std::vector<mxTimestamp> groups;
+		auto rev = feeder::sharedTimeline<>::make(TESTS_TESTDATA_DIR, { "dtohlcv_csvLib_seq_diff_3"
+			, "dtohlcv_csvLib_seq_diff_2", "dtohlcv_csvLib_seq_diff_1" });
+		feedAll(rev, r, groups);
+		ASSERT_EQ(r, ref);
+		ASSERT_EQ(groups, refGroups);
+	}
+}
+
+TEST(TestMultiFile, TrustedData) {
+	using namespace t18;
+
+	typedef decltype("tf"_s) tfid_hst;
+	typedef utils::makeMap_t<utils::Descr_t<tfid_hst, timeseries::Timeframe<tfConverter::baseOhlc>>> TickerTimeframes_hdm;
+	typedef tickerServer<true, TickerTimeframes_hdm> Ticker_t;
+
+	const ::std::string fname(TESTS_TESTDATA_DIR "gen_dtohlcv_cert.csv");
+	{
+		::std::ifstream src(TESTS_TESTDATA_DIR "dtohlcv.csv", ::std::ios::binary);
+		::std::ofstream dst(fname, ::std::ios::binary | ::std::ios::trunc);
+		dst << src.rdbuf();
+	}
+	typedef feeder::dataCertificate cert_t;
+	typedef feeder::adapters::csv_tsohlcv adapt_t;
+	::std::remove((fname + cert_t::sidecarExt).c_str());
+	ASSERT_FALSE(cert_t::isValidFor<adapt_t>(fname.c_str()));
+
+	::std::string err;
+	ASSERT_TRUE(cert_t::issue<adapt_t>(fname.c_str(), &err)) << err;
+	ASSERT_TRUE(cert_t::isValidFor<adapt_t>(fname.c_str()));
+	ASSERT_TRUE(cert_t::isValidFor<adapt_t>(fname.c_str(), true));
+	//the certificate is valid only for the type of records it was issued for
+	ASSERT_FALSE(cert_t::isValidFor<feeder::adapters::csv_tsTick>(fname.c_str()));
+	ASSERT_NE(cert_t::kindOf<tsTick>(), cert_t::kindOf<tsDeal>());
+
+	auto feedAll = [](feeder::multiFile<>& feed, bool& bTrusted) {
+		Mdss_tester<utils::make_set_t<Ticker_t>> mkt;
+		::std::vector<tsohlcv> r;
+		auto& tickr = mkt.newTicker<Ticker_t>("gen_dtohlcv_cert", real_t(.01), tfid_hst(), 3u, 1);
+		auto h = tickr.getTf<tfid_hst>().registerOnNewBarClose([&](const tsohlcv& b) { r.push_back(b); });
+		feed(mkt);
+		bTrusted = tickr.isDataTrusted() && tickr.getTf<tfid_hst>().isDataTrusted();
+		return r;
+	};
+
+	feeder::multiFile<> feed(TESTS_TESTDATA_DIR);
+	bool bTrusted;
+	const auto refLog = feedAll(feed, bTrusted);
+	ASSERT_FALSE(bTrusted);
+	ASSERT_EQ(refLog.size(), 5);
+
+	feed.trustCertifiedData();
+	ASSERT_EQ(feedAll(feed, bTrusted), refLog);
+	ASSERT_TRUE(bTrusted);
+
+	//any change of the file invalidates the certificate
+	{
+		::std::ofstream dst(fname, ::std::ios::binary | ::std::ios::app);
+		dst << "\n";
+	}
+	ASSERT_FALSE(cert_t::isValidFor<adapt_t>(fname.c_str()));
+	ASSERT_EQ(feedAll(feed, bTrusted), refLog);
+	ASSERT_FALSE(bTrusted);
+}
+
 TEST(TestMultiFile, SequenceDiff) {
 	using namespace t18;
 
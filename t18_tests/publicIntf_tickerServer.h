@@ -72,6 +72,17 @@ namespace {
 		void newBarAggregate(mxDate d, mxTime t, real_t o, real_t h, real_t l, real_t c, real_t v) {
 			newBarAggregate(tsohlcv(mxTimestamp(d, t), o, h, l, c, v));
 		}
+
+		void newTick(const ::t18::tsTick& tst) {
+			base_class_t::_newTick_pre(tst);
+			base_class_t::_newTick(tst);
+			base_class_t::_newTick_post();
+		}
+		void newTick(const ::t18::tsDeal& d) {
+			base_class_t::_newTick_pre(d);
+			base_class_t::_newTick(d);
+			base_class_t::_newTick_post();
+		}
 	};
 
 }
@@ -18,10 +18,17 @@
 #include "stdafx.h"
 
 #include "../t18/feeder/adapters/csv.h"
+#include "../t18/feeder/adapters/fastCsv.h"
 #include "../t18/feeder/singleFile.h"
+#include "../t18/feeder/binFile.h"
+#include "../t18/feeder/tailFile.h"
 //#include "../t18/tfConverter/dailyhm.h"
 #include "publicIntf_timeframeServer.h"
 #include "dummyMktFwd.h"
+#include "../t18/utils/scope_exit.h"
+
+#include <thread>
+#include <chrono>
 
 using namespace std::literals;
 
@@ -55,3 +62,362 @@ TEST(TestSingleFile, Basic) {
 	ASSERT_EQ(ts.get("high"_s, 1), 173.53);
 	ASSERT_EQ(ts.get("vol"_s, 2), 46330);
 }
+
+TEST(TestSingleFile, FastCsv) {
+	using namespace t18;
+
+	typedef feeder::adapters::csv_tsohlcv adapt_t;
+	typedef feeder::adapters::fastCsv_tsohlcv fadapt_t;
+	ASSERT_EQ(fadapt_t::capacity(TESTS_TESTDATA_DIR "dtohlcv.csv"), adapt_t::capacity(TESTS_TESTDATA_DIR "dtohlcv.csv"));
+
+	publicIntf_timeframeServer<tfConverter::tfConvBase<tsohlcv>> ts(size_t(5), 1), fts(size_t(5), 1);
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(ts)>(ts), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", adapt_t());
+	feeder::singleFile<fadapt_t>::processFile(dummyMktFwd<decltype(fts)>(fts), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", fadapt_t());
+
+	ASSERT_EQ(fts.TotalBars(), 5);
+	for (size_t i = 0; i < ts.size(); ++i) {
+		ASSERT_EQ(fts.bar(i), ts.bar(i));
+	}
+
+	//the same formats as fscanf based adapters accept
+	auto parse = [](const char* s, auto&& f) {
+		const ::std::string str(s);
+		feeder::adapters::_i::csvRecParser p(str.data(), str.data() + str.size());
+		return f(p) ? p.parsed() : -p.parsed();
+	};
+	mxTimestamp ts1;
+	real_t q;
+	volume_t v;
+	dealnum_t dn;
+	::std::int32_t bl;
+	ASSERT_EQ(parse("20170103,100200, 173.26,46330\r", [&](auto& p) {
+		return p.milDT(ts1) && p.sep() && p.real(q) && p.sep() && p.real(v) && p.end();
+	}), 4);
+	ASSERT_EQ(ts1, mxTimestamp(tag_milDT(), 20170103, 100200));
+	ASSERT_EQ(q, 173.26);
+	ASSERT_EQ(v, 46330);
+
+	ASSERT_EQ(parse("20170103,93000,1e2,2.5,123456789012,-1", [&](auto& p) {
+		return p.milDT(ts1) && p.sep() && p.real(q) && p.sep() && p.real(v) && p.sep() && p.uint(dn) && p.sep() && p.sint(bl) && p.end();
+	}), 6);
+	ASSERT_EQ(ts1, mxTimestamp(tag_milDT(), 20170103, 93000));
+	ASSERT_EQ(q, 100);
+	ASSERT_EQ(dn, 123456789012ull);
+	ASSERT_EQ(bl, -1);
+
+	ASSERT_EQ(parse("20170103,100200,17a", [&](auto& p) {
+		return p.milDT(ts1) && p.sep() && p.real(q) && p.end();
+	}), -3);
+	ASSERT_EQ(parse("20170103;100200", [&](auto& p) { return p.milDT(ts1); }), -1);
+
+	//fields out of their ranges are refused by both the fixed width and the generic decoding
+	for (const char* s : { "20171303,100200", "20170230,100200", "20170103,240000", "20170103,106000", "20170103,100260"
+		, "2017013,100200", "20170103,96000", "18991231,100200", "201701030,100200" })
+	{
+		ASSERT_EQ(parse(s, [&](auto& p) { return p.milDT(ts1); }), -2) << s;
+	}
+	ASSERT_EQ(parse("20160229,90000", [&](auto& p) { return p.milDT(ts1); }), 2);
+	ASSERT_EQ(ts1, mxTimestamp(tag_milDT(), 20160229, 90000));
+}
+
+TEST(TestSingleFile, Index) {
+	using namespace t18;
+
+	typedef feeder::adapters::fastCsv_tsohlcv adapt_t;
+	typedef feeder::adapters::csvIndex index_t;
+	const char* fn = TESTS_TESTDATA_DIR "gen_dtohlcv_indexed.csv";
+	const ::std::string sidecar = ::std::string(fn) + index_t::sidecarExt;
+
+	T18_FILESYSTEM_NAMESPACE::copy_file(TESTS_TESTDATA_DIR "dtohlcv.csv", fn, T18_FILESYSTEM_NAMESPACE::copy_options::overwrite_existing);
+	T18_FILESYSTEM_NAMESPACE::remove(sidecar);
+
+	const auto idx = index_t::build(fn, 2);
+	ASSERT_EQ(idx.count(), 5);
+	ASSERT_EQ(idx.firstTs(), mxTimestamp(tag_milDT(), 20170103, 100000));
+	ASSERT_EQ(idx.lastTs(), mxTimestamp(tag_milDT(), 20170103, 100400));
+	ASSERT_EQ(idx.entries().size(), 3);
+
+	const mxTimestamp from(tag_milDT(), 20170103, 100300), to(tag_milDT(), 20170103, 100400);
+	ASSERT_EQ(idx.offsetBefore(from), idx.entries()[1].ofs);
+	ASSERT_EQ(idx.countUpperBound(from, to), 2);
+	ASSERT_EQ(idx.countUpperBound(mxTimestamp(), mxTimestamp()), 5);
+
+	adapt_t::file_t f(fn);
+	f.seek(idx.entries()[1].ofs);
+	tsohlcv bar;
+	int nRead;
+	ASSERT_TRUE(adapt_t::readNext(f, bar, nRead));
+	ASSERT_EQ(bar, tsohlcv(tag_milDT(), 20170103, 100200, 173.2600000, 173.4000000, 173.2500000, 173.2500000, 46330));
+
+	//the sidecar is created on the first use and then reused
+	ASSERT_FALSE(utils::myFile::exist(sidecar.c_str()));
+	ASSERT_EQ(adapt_t::capacity(fn), 5);
+	ASSERT_TRUE(utils::myFile::exist(sidecar.c_str()));
+	index_t idx2;
+	ASSERT_TRUE(idx2.load(fn));
+	ASSERT_EQ(idx2.count(), 5);
+	ASSERT_EQ(idx2.lastTs(), idx.lastTs());
+
+	publicIntf_timeframeServer<tfConverter::tfConvBase<tsohlcv>> ts(size_t(5), 1);
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(ts)>(ts), 0, fn, adapt_t()
+		, mxTimestamp(tag_milDT(), 20170103, 100100), to);
+	ASSERT_EQ(ts.TotalBars(), 3);
+	ASSERT_EQ(ts.bar(2).TS(), mxTimestamp(tag_milDT(), 20170103, 100100));
+	ASSERT_EQ(ts.bar(0).TS(), mxTimestamp(tag_milDT(), 20170103, 100300));
+
+	//a feeder object loads the index of a file only once
+	feeder::singleFile<adapt_t> sf(fn);
+	sf.setRange(from, to);
+	const auto cap = sf.capacity();
+	ASSERT_TRUE(cap >= 2 && cap <= 5);
+	T18_FILESYSTEM_NAMESPACE::remove(sidecar);
+	ASSERT_EQ(sf.capacity(), cap);
+	ASSERT_FALSE(utils::myFile::exist(sidecar.c_str()));
+}
+
+TEST(TestSingleFile, Prefetch) {
+	using namespace t18;
+
+	auto readAll = [](utils::blockFile& f) {
+		::std::vector<::std::string> r;
+		const char *b, *e;
+		while (f.nextLine(b, e)) r.emplace_back(b, e);
+		return r;
+	};
+
+	const char* fn = TESTS_TESTDATA_DIR "dtohlcv.csv";
+	utils::blockFile ref(fn);
+	const auto lines = readAll(ref);
+	ASSERT_EQ(lines.size(), 5);
+
+	//tiny blocks make lines to span several prefetched blocks
+	for (size_t bs : { 7, 16, 64, 4096 }) {
+		utils::blockFile f(fn, "rb", bs);
+		f.setPrefetch(3);
+		ASSERT_EQ(readAll(f), lines);
+
+		//seeking restarts the prefetching
+		f.seek(0);
+		ASSERT_EQ(readAll(f), lines);
+
+		//turning it off in the middle of the file mustn't lose the data read ahead
+		f.seek(0);
+		const char *b, *e;
+		ASSERT_TRUE(f.nextLine(b, e));
+		ASSERT_EQ(::std::string(b, e), lines[0]);
+		f.setPrefetch(0);
+		auto rest = readAll(f);
+		rest.insert(rest.begin(), lines[0]);
+		ASSERT_EQ(rest, lines);
+	}
+
+	//the adapter
+	typedef feeder::adapters::fastCsv_tsohlcv fadapt_t;
+	typedef feeder::adapters::prefetching<fadapt_t, 2> adapt_t;
+	ASSERT_EQ(adapt_t::file_t().prefetchBlocks(), 2);
+
+	publicIntf_timeframeServer<tfConverter::tfConvBase<tsohlcv>> ts(size_t(5), 1), pts(size_t(5), 1);
+	feeder::singleFile<fadapt_t>::processFile(dummyMktFwd<decltype(ts)>(ts), 0, fn, fadapt_t());
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(pts)>(pts), 0, fn, adapt_t());
+	ASSERT_EQ(pts.TotalBars(), 5);
+	for (size_t i = 0; i < ts.size(); ++i) {
+		ASSERT_EQ(pts.bar(i), ts.bar(i));
+	}
+}
+
+namespace {
+	::std::string readWhole(const char* fn) {
+		::utils::myFile f(fn, "rb");
+		::std::string r;
+		char buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) r.append(buf, n);
+		return r;
+	}
+
+#if defined(T18_WITH_ZSTD) || defined(T18_WITH_LZ4)
+	//compresses src into dst with the compression detected by dst's extension
+	void compressFile(const char* src, const char* dst) {
+		const auto d = readWhole(src);
+		::std::vector<char> out;
+		switch (::utils::compressionOf(dst)) {
+#ifdef T18_WITH_ZSTD
+		case ::utils::compression::zstd:
+			out.resize(ZSTD_compressBound(d.size()));
+			out.resize(ZSTD_compress(out.data(), out.size(), d.data(), d.size(), 3));
+			break;
+#endif
+#ifdef T18_WITH_LZ4
+		case ::utils::compression::lz4:
+			out.resize(LZ4F_compressFrameBound(d.size(), nullptr));
+			out.resize(LZ4F_compressFrame(out.data(), out.size(), d.data(), d.size(), nullptr));
+			break;
+#endif
+		default:
+			throw ::std::logic_error("unsupported compression");
+		}
+		::utils::myFile f(dst, "wb");
+		ASSERT_EQ(fwrite(out.data(), 1, out.size(), f), out.size());
+	}
+#endif
+}
+
+TEST(TestSingleFile, Compressed) {
+	using namespace t18;
+
+	ASSERT_EQ(utils::compressionOf("a.csv"), utils::compression::none);
+	ASSERT_EQ(utils::compressionOf("a.csv.zst"), utils::compression::zstd);
+	ASSERT_EQ(utils::compressionOf("a.csv.lz4"), utils::compression::lz4);
+
+	//the rest requires a decompression library, so it's skipped by the default build (see decompressor.h)
+#if defined(T18_WITH_ZSTD) || defined(T18_WITH_LZ4)
+	::std::vector<const char*> exts;
+#ifdef T18_WITH_ZSTD
+	exts.push_back(".zst");
+#endif
+#ifdef T18_WITH_LZ4
+	exts.push_back(".lz4");
+#endif
+
+	auto readAll = [](utils::blockFile& f) {
+		::std::vector<::std::string> r;
+		const char *b, *e;
+		while (f.nextLine(b, e)) r.emplace_back(b, e);
+		return r;
+	};
+
+	//large enough to span many blocks of compressed input
+	const char* bigFn = TESTS_TESTDATA_DIR "gen_lines.txt";
+	{
+		utils::myFile f(bigFn, "wb");
+		for (int i = 0; i < 100000; ++i) fprintf(f, "line %d of some text to compress %d\n", i, i * 7);
+	}
+	utils::blockFile bigRef(bigFn);
+	const auto bigLines = readAll(bigRef);
+	ASSERT_EQ(bigLines.size(), 100000);
+
+	typedef feeder::adapters::fastCsv_tsohlcv adapt_t;
+	publicIntf_timeframeServer<tfConverter::tfConvBase<tsohlcv>> ts(size_t(5), 1);
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(ts)>(ts), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", adapt_t());
+
+	typedef feeder::binFile<tsohlcv> binFile_t;
+	const char* binFname = TESTS_TESTDATA_DIR "gen_dtohlcv_c.t18bin";
+	ASSERT_EQ(binFile_t::convert<adapt_t>(TESTS_TESTDATA_DIR "dtohlcv.csv", binFname, "dtohlcv", 1), 5);
+	const binFile_t bfRef(binFname);
+
+	for (const char* ext : exts) {
+		const ::std::string cBig = ::std::string(bigFn) + ext;
+		compressFile(bigFn, cBig.c_str());
+
+		for (size_t bs : { 509, 1024 * 1024 }) {
+			for (size_t pf : { 0, 3 }) {
+				utils::blockFile f(cBig.c_str(), "rb", bs);
+				ASSERT_TRUE(f.isCompressed());
+				f.setPrefetch(pf);
+				ASSERT_EQ(readAll(f), bigLines);
+			}
+		}
+
+		//rewinding and seeking forward
+		utils::blockFile f(cBig.c_str());
+		const char *b, *e;
+		for (int i = 0; i < 50000; ++i) ASSERT_TRUE(f.nextLine(b, e));
+		const auto ofs = f.tell();
+		ASSERT_EQ(::std::string(b, e), bigLines[49999]);
+		f.seek(0);
+		ASSERT_TRUE(f.nextLine(b, e));
+		ASSERT_EQ(::std::string(b, e), bigLines[0]);
+		f.seek(ofs);
+		ASSERT_TRUE(f.nextLine(b, e));
+		ASSERT_EQ(::std::string(b, e), bigLines[50000]);
+		//a forward seek with a running prefetch reader
+		utils::blockFile pf(cBig.c_str(), "rb", 509);
+		pf.setPrefetch(3);
+		ASSERT_TRUE(pf.nextLine(b, e));
+		pf.seek(ofs);
+		ASSERT_TRUE(pf.nextLine(b, e));
+		ASSERT_EQ(::std::string(b, e), bigLines[50000]);
+
+		//the text adapter
+		const ::std::string cCsv = ::std::string(TESTS_TESTDATA_DIR "gen_dtohlcv.csv") + ext;
+		compressFile(TESTS_TESTDATA_DIR "dtohlcv.csv", cCsv.c_str());
+		publicIntf_timeframeServer<tfConverter::tfConvBase<tsohlcv>> cts(size_t(5), 1);
+		feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(cts)>(cts), 0, cCsv.c_str(), adapt_t());
+		ASSERT_EQ(cts.TotalBars(), 5);
+		for (size_t i = 0; i < ts.size(); ++i) {
+			ASSERT_EQ(cts.bar(i), ts.bar(i));
+		}
+
+		//the binary format
+		const ::std::string cBin = ::std::string(binFname) + ext;
+		compressFile(binFname, cBin.c_str());
+		const binFile_t bf(cBin.c_str());
+		ASSERT_EQ(bf.size(), bfRef.size());
+		for (size_t i = 0; i < bf.size(); ++i) {
+			ASSERT_EQ(bf[i], bfRef[i]);
+		}
+	}
+#endif
+}
+
+TEST(TestSingleFile, Tail) {
+	using namespace t18;
+
+	typedef feeder::adapters::fastCsv_tsohlcv adapt_t;
+	publicIntf_timeframeServer<tfConverter::tfConvBase<tsohlcv>> ts(size_t(5), 1), tts(size_t(5), 1);
+	feeder::singleFile<adapt_t>::processFile(dummyMktFwd<decltype(ts)>(ts), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", adapt_t());
+
+	const auto src = readWhole(TESTS_TESTDATA_DIR "dtohlcv.csv");
+	::std::vector<size_t> ends;
+	for (size_t p = src.find('\n'); p != ::std::string::npos; p = src.find('\n', p + 1)) ends.push_back(p + 1);
+	ASSERT_EQ(ends.size(), 5);
+
+	const char* fn = TESTS_TESTDATA_DIR "gen_tail.csv";
+	//the file is appended while the feeder reads it
+	utils::myFile w;
+	w.openShared(fn, "wb");
+	auto append = [&w](const ::std::string& s) {
+		ASSERT_EQ(fwrite(s.data(), 1, s.size(), w), s.size());
+		fflush(w);
+	};
+	//the history
+	append(src.substr(0, ends[2]));
+
+	::std::atomic<size_t> nOpened{ 0 };
+	auto h = tts.registerOnNewBarOpen([&nOpened](const tsq_data&) { ++nOpened; });
+	auto waitFor = [&nOpened](size_t n) {
+		for (int i = 0; i < 5000 && nOpened.load() < n; ++i) ::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+		return nOpened.load();
+	};
+
+	feeder::tailFile<adapt_t> tf(fn, adapt_t(), 16);
+	::std::thread th([&tf, &tts]() { tf.feed(tts); });
+	::utils::scope_exit joinFeeder([&tf, &th]() {
+		tf.stop();
+		if (th.joinable()) th.join();
+	});
+
+	ASSERT_EQ(waitFor(3), 3);
+	//a partially written line must wait for its ending
+	append(src.substr(ends[2], ends[3] - ends[2] + 10));
+	ASSERT_EQ(waitFor(4), 4);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(20));
+	ASSERT_EQ(nOpened.load(), 4);
+	append(src.substr(ends[3] + 10));
+	ASSERT_EQ(waitFor(5), 5);
+
+	tf.stop();
+	th.join();
+	ASSERT_EQ(tf.recordsFed(), 5);
+	ASSERT_EQ(tts.TotalBars(), 5);
+	for (size_t i = 0; i < ts.size(); ++i) {
+		ASSERT_EQ(tts.bar(i), ts.bar(i));
+	}
+
+	//a stopped feeder returns after the first block even if there's more data, here the block doesn't hold a whole line
+	feeder::tailFile<adapt_t> tfStopped(fn, adapt_t(), 16);
+	tfStopped.stop();
+	tfStopped.feed(tts);
+	ASSERT_EQ(tfStopped.recordsFed(), 0);
+	ASSERT_EQ(tts.TotalBars(), 5);
+}
@@ -19,8 +19,11 @@
 
 #include "publicIntf_tickerServer.h"
 #include "../t18/feeder/adapters/csv.h"
+#include "../t18/feeder/adapters/fastCsv.h"
 #include "../t18/feeder/singleFile.h"
+#include "../t18/feeder/sharedHistory.h"
 #include "../t18/tfConverter/dailyhm.h"
+#include "../t18/algs/_all.h"
 #include "dummyMktFwd.h"
 
 using namespace std::literals;
@@ -68,6 +71,259 @@ TEST(TestTicker, Basic) {
 	) << "bar2 = " << tsM2.bar(2).to_string();
 }
 
+TEST(TestTicker, Archive) {
+	using namespace t18;
+
+	typedef decltype("base"_s) btf_ht;
+	typedef timeseries::Timeframe<tfConverter::baseOhlc> tfBase_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>))> piticker_t;
+
+	piticker_t tServ(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 2u, 1);
+	auto& tsBase = tServ.getTf("base"_s);
+	tsBase.enableArchive(tServ.getMinPriceDelta(), volume_t(1), 2);
+
+	typedef feeder::adapters::csv_tsohlcv adapt_t;
+	typedef feeder::singleFile<adapt_t> feeder_t;
+	feeder_t::processFile(dummyMktFwd<decltype(tServ)>(tServ), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", adapt_t());
+
+	ASSERT_EQ(tsBase.TotalBars(), 5);
+	ASSERT_EQ(tsBase.size(), 2);
+	ASSERT_TRUE(tsBase.getArchive());
+	ASSERT_EQ(tsBase.getArchive()->size(), 3);
+	ASSERT_EQ(tsBase.historySize(), 5);
+
+	ASSERT_EQ(tsBase.barByNum(0), tsohlcv(tag_milDT(), 20170103, 100000, 173.4100000, 173.5000000, 173.1500000, 173.1500000, 148360));
+	ASSERT_EQ(tsBase.barByNum(1), tsohlcv(tag_milDT(), 20170103, 100100, 173.1500000, 173.3500000, 173.1100000, 173.2600000, 100970));
+	ASSERT_EQ(tsBase.barByNum(2), tsohlcv(tag_milDT(), 20170103, 100200, 173.2600000, 173.4000000, 173.2500000, 173.2500000, 46330));
+	ASSERT_EQ(tsBase.barByNum(3), tsBase.bar(1));
+	ASSERT_EQ(tsBase.barByNum(4), tsBase.bar(0));
+	ASSERT_THROW(tsBase.barByNum(5), ::std::out_of_range);
+
+	size_t n = 0;
+	tsBase.getArchive()->forEach(1, 3, [&n, &tsBase](const tsohlcv& b) {
+		ASSERT_EQ(b, tsBase.barByNum(++n));
+	});
+	ASSERT_EQ(n, 2);
+	ASSERT_EQ(tsBase.getArchive()->offGridCount(), 0);
+
+	//a step that doesn't suit the data: values are rounded and counted
+	timeseries::barsArchive ar(real_t(.1));
+	ASSERT_TRUE(ar.push_back(tsBase.barByNum(0)));
+	ASSERT_EQ(ar.size(), 1);
+	ASSERT_FALSE(ar.allocFailed());
+	//memory for the next bar is reserved anew
+	ar.shrink_to_fit();
+	ASSERT_TRUE(ar.push_back(tsBase.barByNum(1)));
+	ASSERT_EQ(ar.size(), 2);
+	ASSERT_EQ(ar.offGridCount(), 3 + 4);
+	ASSERT_EQ(ar.bar(0).o(), real_t(173.4));
+	ASSERT_EQ(ar.bar(0).h, real_t(173.5));
+}
+
+TEST(TestTicker, PriceTicks) {
+	using namespace t18;
+
+	const priceTicks pt(real_t(.01));
+	ASSERT_EQ(pt.exactTicks(173.41), 17341);
+	ASSERT_EQ(pt.fromTicks(17341), 173.41);
+	ASSERT_EQ(pt.nearest(173.41 + 1e-9), 17341);
+	ASSERT_EQ(pt.snap(173.41 - 1e-9), 173.41);
+	ASSERT_EQ(pt.snap(0.1 + 0.2), 0.3);
+
+	typedef decltype("base"_s) btf_ht;
+	typedef timeseries::Timeframe<tfConverter::baseOhlc> tfBase_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>))> piticker_t;
+
+	piticker_t tServ(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 2u, 1);
+	ASSERT_FALSE(tServ.snapsPricesToTicks());
+	tServ.snapPricesToTicks();
+	ASSERT_TRUE(tServ.snapsPricesToTicks());
+	ASSERT_EQ(tServ.nearestTicks(real_t(.3)), 30);
+	ASSERT_EQ(tServ.fromTicks(30), .3);
+
+	const tsohlcv bar(tag_milDT(), 20170103, 100000, 0.1 + 0.2, 0.3 + 1e-9, 0.29 - 1e-9, 0.1 + 0.2, 10);
+	tServ.newBarOpen(tsq_data(bar.TS(), bar.o()));
+	tServ.newBarAggregate(bar);
+	const auto& tsBase = tServ.getTf("base"_s);
+	ASSERT_EQ(tsBase.bar(0), tsohlcv(tag_milDT(), 20170103, 100000, .3, .3, .29, .3, 10));
+	ASSERT_EQ(tServ.getLastQuote().q, .3);
+}
+
+TEST(TestTicker, MemoryFootprint) {
+	using namespace t18;
+
+	typedef decltype("base"_s) btf_ht;
+	typedef decltype("m2"_s) htf_ht;
+
+	typedef timeseries::Timeframe<tfConverter::baseOhlc> tfBase_t;
+	typedef timeseries::Timeframe<tfConverter::dailyhmOhlc> tfHigher_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>, utils::Descr_v<htf_ht, tfHigher_t>))> piticker_t;
+
+	piticker_t tServ(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 2u, 1);
+	tServ.createTf("m2"_s, 3u, 2);
+	tServ.getTf("base"_s).enableArchive(tServ.getMinPriceDelta());
+
+	typedef feeder::adapters::csv_tsohlcv adapt_t;
+	typedef feeder::singleFile<adapt_t> feeder_t;
+	feeder_t::processFile(dummyMktFwd<decltype(tServ)>(tServ), 0, TESTS_TESTDATA_DIR "dtohlcv.csv", adapt_t());
+
+	const auto fp = tServ.memoryFootprint();
+	ASSERT_EQ(fp.name, "test");
+	ASSERT_EQ(fp.children.size(), 2);
+
+	const auto pBase = fp.find("base");
+	const auto pM2 = fp.find("m2");
+	ASSERT_TRUE(pBase && pM2);
+	ASSERT_EQ(pBase->bytes, sizeof(tfBase_t));
+	ASSERT_EQ(pM2->bytes, sizeof(tfHigher_t));
+
+	const auto pClose = pM2->find(close_ht().c_str());
+	ASSERT_TRUE(pClose);
+	ASSERT_EQ(pClose->bytes, 3 * sizeof(real_t));
+	ASSERT_TRUE(pBase->find("archive"));
+	ASSERT_FALSE(pM2->find("archive"));
+	ASSERT_EQ(pBase->find("archive")->bytes, tServ.getTf("base"_s).getArchive()->bytes());
+
+	ASSERT_EQ(fp.total(), fp.bytes + pBase->total() + pM2->total());
+}
+
+namespace {
+	typedef decltype("base"_s) btf_ht;
+	typedef decltype("m2"_s) htf_ht;
+	typedef timeseries::Timeframe<tfConverter::baseOhlc> tfBase_t;
+	typedef timeseries::Timeframe<tfConverter::dailyhmOhlc> tfHigher_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>, utils::Descr_v<htf_ht, tfHigher_t>))> rwTicker_t;
+
+	//a ticker with an algorithm driven by the base timeframe
+	struct rwTester {
+		rwTicker_t t;
+		algs::DEMA_c dema;
+		utils::regHandle hOpen, hClose, hRewind;
+
+		rwTester() : t(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 10u, 1)
+			, dema(10, t.getTf("base"_s).getTs(close_ht()), algPrms(Prm("len"_s, 2)))
+		{
+			t.createTf("m2"_s, 10u, 2);
+			auto& tf = t.getTf("base"_s);
+			hOpen = tf.registerOnNewBarOpen([this](const tsq_data&) {
+				dema.notifyNewBarOpened();
+				dema(false);
+			});
+			hClose = tf.registerOnNewBarClose([this](const tsohlcv&) { dema(true); });
+			hRewind = tf.registerOnRewind([this](size_t nBars, size_t nClosedBars) { dema.rewind(nBars, nClosedBars); });
+		}
+
+		void feed(const tsohlcv& b) {
+			t.newBarOpen(tsq_data(b.TS(), b.o()));
+			t.newBarAggregate(b);
+		}
+	};
+}
+
+TEST(TestTicker, Rewind) {
+	using namespace t18;
+
+	const tsohlcv bars[] = {
+		tsohlcv(tag_milDT(), 20170103, 100000, 173.4100000, 173.5000000, 173.1500000, 173.1500000, 148360)
+		, tsohlcv(tag_milDT(), 20170103, 100100, 173.1500000, 173.3500000, 173.1100000, 173.2600000, 100970)
+		, tsohlcv(tag_milDT(), 20170103, 100200, 173.2600000, 173.4000000, 173.2500000, 173.2500000, 46330)
+		, tsohlcv(tag_milDT(), 20170103, 100300, 173.3000000, 173.5300000, 173.3000000, 173.5200000, 96690)
+		, tsohlcv(tag_milDT(), 20170103, 100400, 173.5200000, 173.8400000, 173.0000000, 173.5900000, 248160)
+	};
+	//the bar 3 is redrawn
+	const tsohlcv fixedBar(tag_milDT(), 20170103, 100300, 173.3000000, 173.6000000, 173.2000000, 173.4000000, 90000);
+
+	rwTester a;
+	a.dema.enableRewind(4);
+	for (const auto& b : bars) a.feed(b);
+
+	//m2 bar that contains the bar 3 starts at the bar 2, so the replay must start from it
+	ASSERT_EQ(a.t._rewind(fixedBar.TS()), bars[2].TS());
+	ASSERT_EQ(a.t.getTf("base"_s).TotalBars(), 2);
+	ASSERT_EQ(a.t.getTf("m2"_s).TotalBars(), 1);
+	ASSERT_EQ(a.dema.getTs(algs::adpt_dest_ht()).size(), 2);
+	ASSERT_EQ(a.t.getLastSeenTS(), bars[1].TS());
+
+	a.feed(bars[2]);
+	a.feed(fixedBar);
+	a.feed(bars[4]);
+
+	//must be the same as if it was fed by the correct data from the beginning
+	rwTester b;
+	for (size_t i = 0; i < 3; ++i) b.feed(bars[i]);
+	b.feed(fixedBar);
+	b.feed(bars[4]);
+
+	auto cmpTf = [](const auto& x, const auto& y) {
+		ASSERT_EQ(x.TotalBars(), y.TotalBars());
+		ASSERT_EQ(x.size(), y.size());
+		for (size_t i = 0; i < x.size(); ++i) ASSERT_EQ(x.bar(i), y.bar(i));
+	};
+	cmpTf(a.t.getTf("base"_s), b.t.getTf("base"_s));
+	cmpTf(a.t.getTf("m2"_s), b.t.getTf("m2"_s));
+	ASSERT_EQ(a.t.getTf("m2"_s).high(1), fixedBar.h);
+
+	const auto& da = a.dema.getTs(algs::adpt_dest_ht());
+	const auto& db = b.dema.getTs(algs::adpt_dest_ht());
+	ASSERT_EQ(da.size(), 5);
+	ASSERT_EQ(da.size(), db.size());
+	for (size_t i = 0; i < da.size(); ++i) {
+		ASSERT_TRUE(da[i] == db[i] || (isnan(da[i]) && isnan(db[i]))) << "i=" << i;
+	}
+	ASSERT_TRUE(isfinite(da[1]));
+
+	//only the stored bars could be rewound
+	ASSERT_THROW(a.t.getTf("base"_s).rewind(6), ::std::out_of_range);
+}
+
+TEST(TestTicker, SharedHistory) {
+	using namespace t18;
+
+	typedef decltype("base"_s) btf_ht;
+	typedef decltype("m2"_s) htf_ht;
+
+	typedef timeseries::Timeframe<tfConverter::baseOhlc> tfBase_t;
+	typedef timeseries::Timeframe<tfConverter::dailyhmOhlc> tfHigher_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>, utils::Descr_v<htf_ht, tfHigher_t>))> piticker_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<btf_ht, tfBase_t>))> pitickerBase_t;
+
+	typedef feeder::sharedHistory<tsohlcv> hist_t;
+	const auto hist = hist_t::make<feeder::singleFile, feeder::adapters::csv_tsohlcv>(
+		hana::make_tuple(TESTS_TESTDATA_DIR "dtohlcv.csv"), hana::make_tuple());
+	ASSERT_EQ(hist.size(), 5);
+	ASSERT_EQ(hist.lowerBound(mxTimestamp(tag_milDT(), 20170103, 100130)), 2);
+
+	//converting once
+	const auto histM2 = hist.convert(tfConverter::dailyhmOhlc(2));
+	ASSERT_EQ(histM2.size(), 3);
+	ASSERT_EQ(histM2[0], tsohlcv(tag_milDT(), 20170103, 100000, 173.4100000, 173.5000000, 173.1100000, 173.2600000, 100970 + 148360));
+	ASSERT_EQ(histM2[1], tsohlcv(tag_milDT(), 20170103, 100200, 173.2600000, 173.5300000, 173.2500000, 173.5200000, 96690 + 46330));
+	ASSERT_EQ(histM2[2], tsohlcv(tag_milDT(), 20170103, 100400, 173.5200000, 173.8400000, 173.0000000, 173.5900000, 248160));
+
+	for (int run = 0; run < 2; ++run) {
+		const hist_t h = hist;
+		ASSERT_EQ(hist.use_count(), 2);
+
+		piticker_t tServ(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 3u, 1);
+		tServ.createTf("m2"_s, 3u, 2);
+		h.feed(tServ);
+
+		//a ticker fed by the already converted history must have the same data
+		pitickerBase_t tServM2(TickerId::forEveryone(), "test", real_t(.01), "base"_s, 3u, 2);
+		histM2.feed(tServM2);
+
+		auto& tsM2 = tServ.getTf("m2"_s);
+		auto& tsM2c = tServM2.getTf("base"_s);
+		ASSERT_EQ(tsM2.TotalBars(), 3);
+		ASSERT_EQ(tsM2c.TotalBars(), 3);
+		for (size_t i = 0; i < 3; ++i) {
+			ASSERT_EQ(tsM2.bar(i), histM2[2 - i]);
+			ASSERT_EQ(tsM2c.bar(i), histM2[2 - i]);
+		}
+	}
+	ASSERT_EQ(hist.use_count(), 1);
+}
+
 TEST(TestTicker, Sequences) {
 	using namespace t18;
 
@@ -247,3 +503,71 @@ TEST(TestTicker, Sequences) {
 	ASSERT_EQ(tsohlcv(br.TFLowerBoundary(dailyTf), br), daily.lastBar());
 
 }
+
+TEST(TestTicker, Deals) {
+	using namespace t18;
+
+	const char* fn = TESTS_TESTDATA_DIR "gen_deals.csv";
+	{
+		utils::myFile f(fn, "wb");
+		fprintf(f, "20190103,100000,150.50,10,1001,1\n20190103,100010,150.51,5,1002,0\n"
+			"20190103,100030,150.40,7,1005,0\n20190103,100100,150.60,3,1006,1\n");
+	}
+
+	typedef decltype("m1"_s) m1_ht;
+	typedef timeseries::Timeframe<tfConverter::dailyhm<tsohlcv>> tfM1_t;
+	typedef publicIntf_tickerServer<decltype(hana::make_map(utils::Descr_v<m1_ht, tfM1_t>))> piticker_t;
+
+	auto feed = [fn](piticker_t& t, auto adpt) {
+		typedef decltype(adpt) adapt_t;
+		feeder::singleFile<adapt_t>::processFile(dummyMktFwd<piticker_t>(t), 0, fn, adpt);
+	};
+
+	//plain ticks don't have the deal attributes
+	piticker_t tTicks(TickerId::forEveryone(), "test", real_t(.01), "m1"_s, 3u, 1);
+	tTicks.enableDealsHistory(3);
+	feed(tTicks, feeder::adapters::csv_tsTick());
+	ASSERT_EQ(tTicks.getDeals()->size(), 0);
+
+	piticker_t tNoHist(TickerId::forEveryone(), "test", real_t(.01), "m1"_s, 3u, 1);
+	feed(tNoHist, feeder::adapters::csv_tsDeal());
+	ASSERT_EQ(tNoHist.getDeals(), nullptr);
+
+	piticker_t tDeals(TickerId::forEveryone(), "test", real_t(.01), "m1"_s, 3u, 1);
+	tDeals.enableDealsHistory(3);
+	feed(tDeals, feeder::adapters::csv_tsDeal());
+
+	piticker_t tFast(TickerId::forEveryone(), "test", real_t(.01), "m1"_s, 3u, 1);
+	tFast.enableDealsHistory(3);
+	feed(tFast, feeder::adapters::fastCsv_tsDeal());
+
+	//bars are the same in any case
+	const auto& m1 = tTicks.getTf("m1"_s);
+	ASSERT_EQ(m1.TotalBars(), 2);
+	ASSERT_EQ(m1.bar(1), tsohlcv(tag_milDT(), 20190103, 100000, 150.50, 150.51, 150.40, 150.40, 22));
+	for (const piticker_t* pT : { &tNoHist, &tDeals, &tFast }) {
+		const auto& tf = pT->getTf("m1"_s);
+		ASSERT_EQ(tf.TotalBars(), m1.TotalBars());
+		for (size_t i = 0; i < m1.size(); ++i) ASSERT_EQ(tf.bar(i), m1.bar(i));
+	}
+
+	for (const piticker_t* pT : { &tDeals, &tFast }) {
+		const auto& deals = *pT->getDeals();
+		ASSERT_EQ(deals.TotalBars(), 4);
+		ASSERT_EQ(deals.size(), 3);
+		ASSERT_EQ(deals.lastDeal(), tsDeal(tag_milDT(), 20190103, 100100, 150.60, 3, true, 1006));
+		ASSERT_EQ(deals.deal(1), tsDeal(tag_milDT(), 20190103, 100030, 150.40, 7, false, 1005));
+		ASSERT_EQ(deals.dealNum(2), 1002);
+		ASSERT_FALSE(deals.isLong(2));
+		ASSERT_TRUE(deals.isSeen(1005));
+		ASSERT_FALSE(deals.isSeen(1007));
+	}
+
+	//rewinding drops the deals, they're stored again as the data is fed again
+	ASSERT_EQ(tDeals._rewind(mxTimestamp(tag_milDT(), 20190103, 100030)), mxTimestamp(tag_milDT(), 20190103, 100000));
+	ASSERT_EQ(tDeals.getDeals()->size(), 0);
+	ASSERT_FALSE(tDeals.getDeals()->isSeen(1001));
+	feed(tDeals, feeder::adapters::csv_tsDeal());
+	ASSERT_EQ(tDeals.getDeals()->TotalBars(), 4);
+	ASSERT_EQ(tDeals.getDeals()->lastDeal(), tFast.getDeals()->lastDeal());
+}